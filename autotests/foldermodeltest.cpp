@@ -0,0 +1,145 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "../src/foldermodel.h"
+
+#include <QTest>
+
+using namespace OneDrive;
+
+class FolderModelTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void testUpdate();
+    void testRename();
+    void testMove();
+    void testDelete();
+    void testUnknownParent();
+
+private:
+    FolderModel m_model;
+};
+
+QTEST_GUILESS_MAIN(FolderModelTest)
+
+namespace
+{
+DriveItem item(const QString &id, const QString &name, const QString &parentId, bool isFolder = false)
+{
+    DriveItem item;
+    item.id = id;
+    item.name = name;
+    item.parentId = parentId;
+    item.isFolder = isFolder;
+    return item;
+}
+
+DriveItem deleted(const QString &id)
+{
+    DriveItem item;
+    item.id = id;
+    item.deleted = true;
+    return item;
+}
+
+QStringList childNames(const FolderModel &model, const QString &folderId)
+{
+    QStringList names;
+    const QList<DriveItem> children = model.children(folderId);
+    for (const DriveItem &child : children) {
+        names.append(child.name);
+    }
+    names.sort();
+    return names;
+}
+} // namespace
+
+void FolderModelTest::init()
+{
+    // root
+    // ├── docs/
+    // │   └── a.txt
+    // ├── photos/
+    // │   └── b.jpg
+    // └── c.txt
+    m_model.clear();
+    m_model.setChildren(QStringLiteral("root"),
+                        {item(QStringLiteral("docs"), QStringLiteral("Documents"), QStringLiteral("root"), true),
+                         item(QStringLiteral("photos"), QStringLiteral("Photos"), QStringLiteral("root"), true),
+                         item(QStringLiteral("c"), QStringLiteral("c.txt"), QStringLiteral("root"))});
+    m_model.setChildren(QStringLiteral("docs"), {item(QStringLiteral("a"), QStringLiteral("a.txt"), QStringLiteral("docs"))});
+    m_model.setChildren(QStringLiteral("photos"), {item(QStringLiteral("b"), QStringLiteral("b.jpg"), QStringLiteral("photos"))});
+}
+
+void FolderModelTest::testUpdate()
+{
+    DriveItem changed = item(QStringLiteral("a"), QStringLiteral("a.txt"), QStringLiteral("docs"));
+    changed.size = 42;
+
+    // Ancestors of a change come along with it, unchanged, and the root has no parent.
+    DriveItem root;
+    root.id = QStringLiteral("root");
+    root.isFolder = true;
+    const QStringList relocated =
+        m_model.applyDelta({root, item(QStringLiteral("docs"), QStringLiteral("Documents"), QStringLiteral("root"), true), changed});
+
+    QVERIFY(relocated.isEmpty());
+    QCOMPARE(m_model.children(QStringLiteral("docs")).size(), qsizetype(1));
+    QCOMPARE(m_model.children(QStringLiteral("docs")).constFirst().size, qint64(42));
+    QCOMPARE(childNames(m_model, QStringLiteral("root")).size(), qsizetype(3));
+}
+
+void FolderModelTest::testRename()
+{
+    const QStringList relocated = m_model.applyDelta({item(QStringLiteral("docs"), QStringLiteral("Papers"), QStringLiteral("root"), true)});
+
+    QCOMPARE(relocated, QStringList({QStringLiteral("docs")}));
+    QCOMPARE(childNames(m_model, QStringLiteral("root")), QStringList({QStringLiteral("Papers"), QStringLiteral("Photos"), QStringLiteral("c.txt")}));
+    // The folder's own children didn't change.
+    QCOMPARE(childNames(m_model, QStringLiteral("docs")), QStringList({QStringLiteral("a.txt")}));
+}
+
+void FolderModelTest::testMove()
+{
+    const QStringList relocated = m_model.applyDelta({item(QStringLiteral("a"), QStringLiteral("a.txt"), QStringLiteral("photos")),
+                                                      item(QStringLiteral("photos"), QStringLiteral("Photos"), QStringLiteral("docs"), true)});
+
+    QCOMPARE(relocated, QStringList({QStringLiteral("a"), QStringLiteral("photos")}));
+    QCOMPARE(childNames(m_model, QStringLiteral("root")), QStringList({QStringLiteral("Documents"), QStringLiteral("c.txt")}));
+    QCOMPARE(childNames(m_model, QStringLiteral("docs")), QStringList({QStringLiteral("Photos")}));
+    QCOMPARE(childNames(m_model, QStringLiteral("photos")), QStringList({QStringLiteral("a.txt"), QStringLiteral("b.jpg")}));
+}
+
+void FolderModelTest::testDelete()
+{
+    const QStringList relocated = m_model.applyDelta({deleted(QStringLiteral("photos")), deleted(QStringLiteral("c"))});
+
+    QCOMPARE(relocated, QStringList({QStringLiteral("photos"), QStringLiteral("c")}));
+    QVERIFY(!m_model.hasFolder(QStringLiteral("photos")));
+    QCOMPARE(childNames(m_model, QStringLiteral("root")), QStringList({QStringLiteral("Documents")}));
+}
+
+void FolderModelTest::testUnknownParent()
+{
+    // Moving an item out of the model drops it, moving one in adds it.
+    QStringList relocated = m_model.applyDelta({item(QStringLiteral("c"), QStringLiteral("c.txt"), QStringLiteral("elsewhere")),
+                                                item(QStringLiteral("d"), QStringLiteral("d.txt"), QStringLiteral("docs")),
+                                                item(QStringLiteral("e"), QStringLiteral("e.txt"), QStringLiteral("elsewhere"))});
+    QCOMPARE(relocated, QStringList({QStringLiteral("c")}));
+    QCOMPARE(childNames(m_model, QStringLiteral("root")), QStringList({QStringLiteral("Documents"), QStringLiteral("Photos")}));
+    QCOMPARE(childNames(m_model, QStringLiteral("docs")), QStringList({QStringLiteral("a.txt"), QStringLiteral("d.txt")}));
+
+    // A listed folder whose parent was never listed may have been renamed or moved, there is nothing to compare with.
+    m_model.setChildren(QStringLiteral("deep"), {item(QStringLiteral("f"), QStringLiteral("f.txt"), QStringLiteral("deep"))});
+    relocated = m_model.applyDelta({item(QStringLiteral("deep"), QStringLiteral("Deep"), QStringLiteral("elsewhere"), true)});
+    QCOMPARE(relocated, QStringList({QStringLiteral("deep")}));
+    QCOMPARE(childNames(m_model, QStringLiteral("deep")), QStringList({QStringLiteral("f.txt")}));
+}
+
+#include "foldermodeltest.moc"
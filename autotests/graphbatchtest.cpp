@@ -0,0 +1,248 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "../src/graphbatch.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTest>
+
+#include <algorithm>
+
+using namespace OneDrive;
+
+class GraphBatchTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testDependencyOrder();
+    void testInvalidRequests();
+    void testChunking();
+    void testFailedDependencyInEarlierRoundTrip();
+    void testThrottledRequestsAreRetried();
+    void testThrottledRequestsGiveUp();
+    void testMissingResponses();
+};
+
+QTEST_GUILESS_MAIN(GraphBatchTest)
+
+namespace
+{
+BatchRequest request(const QString &id, const QStringList &dependsOn = QStringList())
+{
+    return BatchRequest{id, QByteArrayLiteral("DELETE"), QStringLiteral("/me/drive/items/%1").arg(id), QJsonObject(), dependsOn};
+}
+
+QJsonArray sentRequests(const QByteArray &payload)
+{
+    return QJsonDocument::fromJson(payload).object().value(QStringLiteral("requests")).toArray();
+}
+
+QStringList sentIds(const QByteArray &payload)
+{
+    QStringList ids;
+    const QJsonArray requests = sentRequests(payload);
+    for (const QJsonValue &value : requests) {
+        ids.append(value.toObject().value(QStringLiteral("id")).toString());
+    }
+    return ids;
+}
+
+struct MockResponse {
+    QString id;
+    int status = 204;
+    QString retryAfter;
+};
+
+// The body of a POST /$batch reply.
+QByteArray mockReply(const QList<MockResponse> &responses)
+{
+    QJsonArray values;
+    for (const MockResponse &response : responses) {
+        QJsonObject value;
+        value.insert(QStringLiteral("id"), response.id);
+        value.insert(QStringLiteral("status"), response.status);
+        if (!response.retryAfter.isEmpty()) {
+            value.insert(QStringLiteral("headers"), QJsonObject{{QStringLiteral("Retry-After"), response.retryAfter}});
+        }
+        values.append(value);
+    }
+    return QJsonDocument(QJsonObject{{QStringLiteral("responses"), values}}).toJson(QJsonDocument::Compact);
+}
+
+QByteArray succeedAll(const QByteArray &payload)
+{
+    QList<MockResponse> responses;
+    for (const QString &id : sentIds(payload)) {
+        responses.append(MockResponse{id});
+    }
+    return mockReply(responses);
+}
+} // namespace
+
+void GraphBatchTest::testDependencyOrder()
+{
+    BatchPlan plan({request(QStringLiteral("c"), {QStringLiteral("b")}), request(QStringLiteral("b"), {QStringLiteral("a")}), request(QStringLiteral("a"))});
+    QVERIFY(plan.error().isEmpty());
+
+    const QByteArray payload = plan.nextPayload();
+    QCOMPARE(sentIds(payload), QStringList({QStringLiteral("a"), QStringLiteral("b"), QStringLiteral("c")}));
+    const QJsonArray requests = sentRequests(payload);
+    QVERIFY(!requests.at(0).toObject().contains(QStringLiteral("dependsOn")));
+    QCOMPARE(requests.at(1).toObject().value(QStringLiteral("dependsOn")).toArray(), QJsonArray({QStringLiteral("a")}));
+    QCOMPARE(requests.at(2).toObject().value(QStringLiteral("dependsOn")).toArray(), QJsonArray({QStringLiteral("b")}));
+    QCOMPARE(requests.at(0).toObject().value(QStringLiteral("method")).toString(), QStringLiteral("DELETE"));
+
+    QCOMPARE(plan.applyReply(succeedAll(payload)), qint64(0));
+    QVERIFY(!plan.hasPending());
+
+    // Responses come back in the order the requests were given.
+    const QList<BatchResponse> responses = plan.responses();
+    QCOMPARE(responses.size(), qsizetype(3));
+    QCOMPARE(responses.at(0).id, QStringLiteral("c"));
+    QCOMPARE(responses.at(2).id, QStringLiteral("a"));
+    QCOMPARE(responses.at(0).httpStatus, 204);
+}
+
+void GraphBatchTest::testInvalidRequests()
+{
+    const QList<QList<BatchRequest>> invalid{
+        {request(QString())},
+        {request(QStringLiteral("a")), request(QStringLiteral("a"))},
+        {request(QStringLiteral("a"), {QStringLiteral("x")})},
+        {request(QStringLiteral("a"), {QStringLiteral("b")}), request(QStringLiteral("b"), {QStringLiteral("a")})},
+    };
+    for (const QList<BatchRequest> &requests : invalid) {
+        BatchPlan plan(requests);
+        QVERIFY(!plan.error().isEmpty());
+        QVERIFY(!plan.hasPending());
+    }
+}
+
+void GraphBatchTest::testChunking()
+{
+    QList<BatchRequest> requests;
+    for (int i = 0; i < 45; ++i) {
+        requests.append(request(QString::number(i)));
+    }
+
+    BatchPlan plan(requests);
+    QList<qsizetype> roundTrips;
+    while (plan.hasPending()) {
+        const QByteArray payload = plan.nextPayload();
+        roundTrips.append(sentIds(payload).size());
+        QCOMPARE(plan.applyReply(succeedAll(payload)), qint64(0));
+    }
+    QCOMPARE(roundTrips, QList<qsizetype>({20, 20, 5}));
+
+    const QList<BatchResponse> responses = plan.responses();
+    QVERIFY(std::all_of(responses.cbegin(), responses.cend(), [](const BatchResponse &response) {
+        return response.httpStatus == 204;
+    }));
+}
+
+void GraphBatchTest::testFailedDependencyInEarlierRoundTrip()
+{
+    QList<BatchRequest> requests;
+    for (int i = 0; i < BatchPlan::MaxBatchSize; ++i) {
+        requests.append(request(QString::number(i)));
+    }
+    requests.append(request(QStringLiteral("late"), {QStringLiteral("0")}));
+
+    BatchPlan plan(requests);
+    const QByteArray first = plan.nextPayload();
+    QCOMPARE(sentIds(first).size(), BatchPlan::MaxBatchSize);
+    QList<MockResponse> responses{MockResponse{QStringLiteral("0"), 404}};
+    for (int i = 1; i < BatchPlan::MaxBatchSize; ++i) {
+        responses.append(MockResponse{QString::number(i)});
+    }
+    plan.applyReply(mockReply(responses));
+
+    // The dependent request is answered without a round trip.
+    QVERIFY(plan.hasPending());
+    QVERIFY(plan.nextPayload().isEmpty());
+    QVERIFY(!plan.hasPending());
+    QCOMPARE(plan.responses().constLast().httpStatus, 424);
+    QCOMPARE(plan.responses().constFirst().httpStatus, 404);
+}
+
+void GraphBatchTest::testThrottledRequestsAreRetried()
+{
+    BatchPlan plan({request(QStringLiteral("a")), request(QStringLiteral("b"), {QStringLiteral("a")}), request(QStringLiteral("c"))});
+
+    QCOMPARE(sentIds(plan.nextPayload()).size(), qsizetype(3));
+    const qint64 delayMs = plan.applyReply(
+        mockReply({MockResponse{QStringLiteral("a"), 429, QStringLiteral("7")}, MockResponse{QStringLiteral("b"), 424}, MockResponse{QStringLiteral("c")}}));
+    QCOMPARE(delayMs, qint64(7000));
+    QVERIFY(plan.hasPending());
+
+    // The throttled request goes again, with the one that failed because of it.
+    const QByteArray second = plan.nextPayload();
+    QCOMPARE(sentIds(second), QStringList({QStringLiteral("a"), QStringLiteral("b")}));
+    QCOMPARE(sentRequests(second).at(1).toObject().value(QStringLiteral("dependsOn")).toArray(), QJsonArray({QStringLiteral("a")}));
+    QCOMPARE(plan.applyReply(succeedAll(second)), qint64(0));
+    QVERIFY(!plan.hasPending());
+
+    for (const BatchResponse &response : plan.responses()) {
+        QCOMPARE(response.httpStatus, 204);
+    }
+}
+
+void GraphBatchTest::testThrottledRequestsGiveUp()
+{
+    BatchPlan plan({request(QStringLiteral("a"))});
+
+    int roundTrips = 0;
+    qint64 lastDelayMs = 0;
+    while (plan.hasPending()) {
+        QCOMPARE(sentIds(plan.nextPayload()), QStringList({QStringLiteral("a")}));
+        ++roundTrips;
+        const qint64 delayMs = plan.applyReply(mockReply({MockResponse{QStringLiteral("a"), 503}}));
+        if (plan.hasPending()) {
+            // Without Retry-After the wait doubles.
+            QVERIFY(delayMs > lastDelayMs);
+            lastDelayMs = delayMs;
+        }
+    }
+    QCOMPARE(roundTrips, BatchPlan::MaxThrottledAttempts);
+    QCOMPARE(plan.responses().constFirst().httpStatus, 503);
+
+    // Dropping the throttled requests leaves the ones that were never sent.
+    QList<BatchRequest> requests;
+    for (int i = 0; i < BatchPlan::MaxBatchSize + 5; ++i) {
+        requests.append(request(QString::number(i)));
+    }
+    BatchPlan dropped(requests);
+    QList<MockResponse> responses{MockResponse{QStringLiteral("0"), 429, QStringLiteral("120")}};
+    for (int i = 1; i < BatchPlan::MaxBatchSize; ++i) {
+        responses.append(MockResponse{QString::number(i)});
+    }
+    QCOMPARE(sentIds(dropped.nextPayload()).size(), BatchPlan::MaxBatchSize);
+    QCOMPARE(dropped.applyReply(mockReply(responses)), qint64(120000));
+    dropped.dropThrottled();
+    QVERIFY(dropped.hasPending());
+    const QByteArray rest = dropped.nextPayload();
+    QCOMPARE(sentIds(rest), QStringList({QStringLiteral("20"), QStringLiteral("21"), QStringLiteral("22"), QStringLiteral("23"), QStringLiteral("24")}));
+    QCOMPARE(dropped.applyReply(succeedAll(rest)), qint64(0));
+    QVERIFY(!dropped.hasPending());
+    QCOMPARE(dropped.responses().constFirst().httpStatus, 429);
+    QCOMPARE(dropped.responses().constLast().httpStatus, 204);
+}
+
+void GraphBatchTest::testMissingResponses()
+{
+    BatchPlan plan({request(QStringLiteral("a")), request(QStringLiteral("b"))});
+    QVERIFY(!plan.nextPayload().isEmpty());
+    QCOMPARE(plan.applyReply(mockReply({MockResponse{QStringLiteral("a")}})), qint64(0));
+
+    const QList<BatchResponse> responses = plan.responses();
+    QCOMPARE(responses.at(0).httpStatus, 204);
+    QCOMPARE(responses.at(1).id, QStringLiteral("b"));
+    QCOMPARE(responses.at(1).httpStatus, 500);
+}
+
+#include "graphbatchtest.moc"
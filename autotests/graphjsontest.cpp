@@ -0,0 +1,198 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "../src/graphjson.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTest>
+
+using namespace OneDrive;
+
+class GraphJsonTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testParseListPage_data();
+    void testParseListPage();
+    void testSharedWithMePage();
+    void testMalformedPage();
+    void benchmarkDocumentParser();
+    void benchmarkStreamingParser();
+};
+
+QTEST_GUILESS_MAIN(GraphJsonTest)
+
+namespace
+{
+QByteArray fileEntry(int index)
+{
+    return QStringLiteral(R"({"@odata.etag":"\"{%1},1\"","id":"01ABCDEF%1","name":"document %1.odt","size":%2,"eTag":"\"{%1},1\"","cTag":"\"c:{%1},1\"",)"
+                          R"("createdDateTime":"2024-03-01T10:00:00Z","lastModifiedDateTime":"2024-03-02T11:30:00Z",)"
+                          R"("webUrl":"https://onedrive.live.com/?id=01ABCDEF%1",)"
+                          R"("createdBy":{"user":{"displayName":"Jane Doe","id":"1234"}},)"
+                          R"("lastModifiedBy":{"application":{"displayName":"OneDrive"},"user":{"displayName":"John \"JD\" Doe"}},)"
+                          R"("parentReference":{"driveId":"b!drive","driveType":"personal","id":"01PARENT","path":"/drive/root:/Documents"},)"
+                          R"("file":{"mimeType":"application/vnd.oasis.opendocument.text","hashes":{"quickXorHash":"AAAAAAAAAAAAAAAAAAAAAAAAAAA=",)"
+                          R"("sha1Hash":"DA39A3EE5E6B4B0D3255BFEF95601890AFD80709"}},)"
+                          R"("fileSystemInfo":{"createdDateTime":"2024-03-01T10:00:00Z"},)"
+                          R"("@microsoft.graph.downloadUrl":"https://public.dm.files.1drv.com/y4m%1?a=b&c=d"})")
+        .arg(index)
+        .arg(1000LL * index + 17)
+        .toUtf8();
+}
+
+QByteArray folderEntry(int index)
+{
+    return QStringLiteral(R"({"id":"01FOLDER%1","name":"Café %1 😀","size":0,"lastModifiedDateTime":"2024-01-01T00:00:00Z",)"
+                          R"("parentReference":{"driveId":"b!drive","id":"01PARENT","path":"/drive/root:"},"folder":{"childCount":%1}})")
+        .arg(index)
+        .toUtf8();
+}
+
+QByteArray listPage(int items, const QByteArray &nextLink = QByteArray())
+{
+    QByteArray payload = R"({"@odata.context":"https://graph.microsoft.com/v1.0/$metadata#Collection(driveItem)",)";
+    if (!nextLink.isEmpty()) {
+        payload += R"("@odata.nextLink":")" + nextLink + R"(",)";
+    }
+    payload += R"("value":[)";
+    for (int i = 0; i < items; ++i) {
+        if (i > 0) {
+            payload += ',';
+        }
+        payload += i % 10 == 0 ? folderEntry(i) : fileEntry(i);
+    }
+    payload += "]}";
+    return payload;
+}
+
+QList<DriveItem> parseWithDocument(const QByteArray &payload)
+{
+    QList<DriveItem> items;
+    const QJsonArray values = QJsonDocument::fromJson(payload).object().value(QStringLiteral("value")).toArray();
+    for (const QJsonValue &value : values) {
+        items.append(parseDriveItem(value.toObject()));
+    }
+    return items;
+}
+
+void compareItems(const DriveItem &actual, const DriveItem &expected)
+{
+    QCOMPARE(actual.id, expected.id);
+    QCOMPARE(actual.name, expected.name);
+    QCOMPARE(actual.parentId, expected.parentId);
+    QCOMPARE(actual.parentPath, expected.parentPath);
+    QCOMPARE(actual.driveId, expected.driveId);
+    QCOMPARE(actual.remoteDriveId, expected.remoteDriveId);
+    QCOMPARE(actual.remoteItemId, expected.remoteItemId);
+    QCOMPARE(actual.mimeType, expected.mimeType);
+    QCOMPARE(actual.downloadUrl, expected.downloadUrl);
+    QCOMPARE(actual.webUrl, expected.webUrl);
+    QCOMPARE(actual.eTag, expected.eTag);
+    QCOMPARE(actual.cTag, expected.cTag);
+    QCOMPARE(actual.quickXorHash, expected.quickXorHash);
+    QCOMPARE(actual.sha1Hash, expected.sha1Hash);
+    QCOMPARE(actual.createdBy, expected.createdBy);
+    QCOMPARE(actual.lastModifiedBy, expected.lastModifiedBy);
+    QCOMPARE(actual.createdTime, expected.createdTime);
+    QCOMPARE(actual.isFolder, expected.isFolder);
+    QCOMPARE(actual.deleted, expected.deleted);
+    QCOMPARE(actual.size, expected.size);
+    QCOMPARE(actual.lastModified, expected.lastModified);
+}
+} // namespace
+
+void GraphJsonTest::testParseListPage_data()
+{
+    QTest::addColumn<QByteArray>("payload");
+    QTest::addColumn<QString>("expectedNextLink");
+    QTest::addColumn<QString>("expectedDeltaLink");
+
+    QTest::newRow("empty page") << QByteArray(R"({"value":[]})") << QString() << QString();
+    QTest::newRow("single page") << listPage(25) << QString() << QString();
+    QTest::newRow("with next link") << listPage(3, "https://graph.microsoft.com/v1.0/me/drive/root/children?$skiptoken=abc")
+                                    << QStringLiteral("https://graph.microsoft.com/v1.0/me/drive/root/children?$skiptoken=abc") << QString();
+    QTest::newRow("delta page") << QByteArray(R"({"value":[{"id":"gone","deleted":{"state":"deleted"},"file":null},)"
+                                              R"({"id":"moved","name":"x","parentReference":{"id":"other"}}],)"
+                                              R"("@odata.deltaLink":"https:\/\/graph.microsoft.com\/v1.0\/me\/drive\/root\/delta?token=xyz"})")
+                                << QString() << QStringLiteral("https://graph.microsoft.com/v1.0/me/drive/root/delta?token=xyz");
+    QTest::newRow("whitespace") << QByteArray("{\n  \"value\" : [ { \"id\" : \"a\" , \"size\" : 1.5e3 , \"folder\" : { } } ]\n}\n") << QString()
+                                << QString();
+}
+
+void GraphJsonTest::testParseListPage()
+{
+    QFETCH(QByteArray, payload);
+    QFETCH(QString, expectedNextLink);
+    QFETCH(QString, expectedDeltaLink);
+
+    const ListPage page = parseListPage(payload);
+    QVERIFY(page.valid);
+    QCOMPARE(page.nextLink, expectedNextLink);
+    QCOMPARE(page.deltaLink, expectedDeltaLink);
+
+    const QList<DriveItem> expected = parseWithDocument(payload);
+    QCOMPARE(page.items.size(), expected.size());
+    for (qsizetype i = 0; i < expected.size(); ++i) {
+        compareItems(page.items.at(i), expected.at(i));
+    }
+}
+
+void GraphJsonTest::testSharedWithMePage()
+{
+    const QByteArray payload = R"({"value":[{"id":"local","name":"Shared",)"
+                               R"("remoteItem":{"id":"remote","name":"Shared","size":42,"file":{"mimeType":"text/plain"},)"
+                               R"("parentReference":{"driveId":"otherdrive","id":"otherparent"}}}]})";
+
+    const ListPage page = parseListPage(payload, ListItemSource::RemoteItem);
+    QVERIFY(page.valid);
+    QCOMPARE(page.items.size(), qsizetype(1));
+
+    const DriveItem &item = page.items.first();
+    QCOMPARE(item.id, QStringLiteral("local"));
+    QCOMPARE(item.remoteItemId, QStringLiteral("remote"));
+    QCOMPARE(item.remoteDriveId, QStringLiteral("otherdrive"));
+    QCOMPARE(item.driveId, QStringLiteral("otherdrive"));
+    QCOMPARE(item.size, qint64(42));
+    QCOMPARE(item.mimeType, QStringLiteral("text/plain"));
+}
+
+void GraphJsonTest::testMalformedPage()
+{
+    QVERIFY(!parseListPage(QByteArray()).valid);
+    QVERIFY(!parseListPage(QByteArray(R"({"value":[{"id":"a"})")).valid);
+    QVERIFY(!parseListPage(QByteArray(R"({"value":[{"id":"a\q"}]})")).valid);
+    QVERIFY(!parseListPage(QByteArray(R"({"value":[]} trailing)")).valid);
+}
+
+void GraphJsonTest::benchmarkDocumentParser()
+{
+    const QByteArray payload = listPage(200, "https://graph.microsoft.com/v1.0/me/drive/root/children?$skiptoken=abc");
+    QBENCHMARK {
+        const QJsonObject root = QJsonDocument::fromJson(payload).object();
+        QList<DriveItem> items;
+        const QJsonArray values = root.value(QStringLiteral("value")).toArray();
+        for (const QJsonValue &value : values) {
+            items.append(parseDriveItem(value.toObject()));
+        }
+        QCOMPARE(items.size(), qsizetype(200));
+        QVERIFY(!root.value(QStringLiteral("@odata.nextLink")).toString().isEmpty());
+    }
+}
+
+void GraphJsonTest::benchmarkStreamingParser()
+{
+    const QByteArray payload = listPage(200, "https://graph.microsoft.com/v1.0/me/drive/root/children?$skiptoken=abc");
+    QBENCHMARK {
+        const ListPage page = parseListPage(payload);
+        QCOMPARE(page.items.size(), qsizetype(200));
+        QVERIFY(!page.nextLink.isEmpty());
+    }
+}
+
+#include "graphjsontest.moc"
@@ -0,0 +1,108 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "../src/quickxorhash.h"
+
+#include <QTest>
+
+using namespace OneDrive;
+
+class QuickXorHashTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testHash_data();
+    void testHash();
+    void testSplitData();
+    void testMatches();
+    void benchmarkHash();
+};
+
+QTEST_GUILESS_MAIN(QuickXorHashTest)
+
+namespace
+{
+QByteArray pattern(qsizetype size)
+{
+    QByteArray data(size, Qt::Uninitialized);
+    for (qsizetype i = 0; i < size; ++i) {
+        data[i] = char((i * 7 + 3) & 0xff);
+    }
+    return data;
+}
+} // namespace
+
+void QuickXorHashTest::testHash_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<QByteArray>("expected");
+
+    // Expected values come from Microsoft's reference implementation.
+    QTest::newRow("empty") << QByteArray() << QByteArray("AAAAAAAAAAAAAAAAAAAAAAAAAAA=");
+    QTest::newRow("a") << QByteArray("a") << QByteArray("YQAAAAAAAAAAAAAAAQAAAAAAAAA=");
+    QTest::newRow("abc") << QByteArray("abc") << QByteArray("YRDDGAAAAAAAAAAAAwAAAAAAAAA=");
+    QTest::newRow("sentence") << QByteArray("The quick brown fox jumps over the lazy dog") << QByteArray("bMSlbysmxJL6S75XwfMcQZOpcr4=");
+    QTest::newRow("19 bytes") << pattern(19) << QByteArray("gl0z1HPQARO0gAY7A0ISoHAFL5Q=");
+    QTest::newRow("159 bytes") << pattern(159) << QByteArray("7gi7SoTZMRx5gfdOM7shn/kHQ6E=");
+    QTest::newRow("160 bytes") << pattern(160) << QByteArray("7gi7SoTZMRx5gfdODLshn/kHw6o=");
+    QTest::newRow("161 bytes") << pattern(161) << QByteArray("jQi7SoTZMRx5gfdODbshn/kHw6o=");
+    QTest::newRow("1000 bytes") << pattern(1000) << QByteArray("dgD8j0n8sM0aPE5CUJ8tqmilX/E=");
+    QTest::newRow("100000 bytes") << pattern(100000) << QByteArray("7gi7SoTZMRx5gfdODD0gn/kHw6o=");
+}
+
+void QuickXorHashTest::testHash()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(QByteArray, expected);
+
+    QCOMPARE(QuickXorHash::hash(data).toBase64(), expected);
+}
+
+void QuickXorHashTest::testSplitData()
+{
+    const QByteArray data = pattern(4096);
+    const QByteArray expected = QuickXorHash::hash(data);
+
+    // Chunk sizes that do and don't line up with the 160 byte blocks.
+    for (const qsizetype chunkSize : {1, 37, 160, 161, 1000}) {
+        QuickXorHash hash;
+        for (qsizetype offset = 0; offset < data.size(); offset += chunkSize) {
+            hash.addData(QByteArrayView(data).mid(offset, chunkSize));
+        }
+        QCOMPARE(hash.result(), expected);
+    }
+
+    QuickXorHash hash;
+    hash.addData(QByteArrayView(data).first(100));
+    hash.reset();
+    hash.addData(data);
+    QCOMPARE(hash.result(), expected);
+}
+
+void QuickXorHashTest::testMatches()
+{
+    QuickXorHash hash;
+    hash.addData("abc");
+    QVERIFY(hash.matches(QStringLiteral("YRDDGAAAAAAAAAAAAwAAAAAAAAA=")));
+    QVERIFY(!hash.matches(QStringLiteral("YQAAAAAAAAAAAAAAAQAAAAAAAAA=")));
+    QVERIFY(!hash.matches(QString()));
+}
+
+void QuickXorHashTest::benchmarkHash()
+{
+    // Downloads hand over chunks of up to 1 MiB.
+    const QByteArray chunk = pattern(1024 * 1024);
+    QBENCHMARK {
+        QuickXorHash hash;
+        for (int i = 0; i < 64; ++i) {
+            hash.addData(chunk);
+        }
+        QCOMPARE(hash.result().size(), qsizetype(20));
+    }
+}
+
+#include "quickxorhashtest.moc"
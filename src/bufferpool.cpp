@@ -0,0 +1,59 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "bufferpool.h"
+
+namespace OneDrive
+{
+BufferPool::BufferPool(qsizetype maxRetainedBytes)
+    : m_maxRetainedBytes(maxRetainedBytes)
+{
+}
+
+QByteArray BufferPool::acquire(qsizetype capacity)
+{
+    qsizetype best = -1;
+    qsizetype largest = -1;
+    for (qsizetype i = 0; i < m_free.size(); ++i) {
+        const qsizetype available = m_free.at(i).capacity();
+        if (available >= capacity && (best < 0 || available < m_free.at(best).capacity())) {
+            best = i;
+        }
+        if (largest < 0 || available > m_free.at(largest).capacity()) {
+            largest = i;
+        }
+    }
+    if (best < 0) {
+        // Nothing big enough; growing the largest one still saves an allocation.
+        best = largest;
+    }
+
+    QByteArray buffer;
+    if (best >= 0) {
+        buffer = m_free.takeAt(best);
+        m_retainedBytes -= buffer.capacity();
+    }
+    buffer.reserve(capacity);
+    return buffer;
+}
+
+void BufferPool::release(QByteArray &&buffer)
+{
+    if (!buffer.isDetached() || buffer.capacity() == 0 || m_retainedBytes + buffer.capacity() > m_maxRetainedBytes) {
+        return;
+    }
+    // resize() keeps the allocation, clear() would free it.
+    buffer.resize(0);
+    m_retainedBytes += buffer.capacity();
+    m_free.append(std::move(buffer));
+}
+
+void BufferPool::clear()
+{
+    m_free.clear();
+    m_retainedBytes = 0;
+}
+}
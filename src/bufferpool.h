@@ -0,0 +1,42 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+
+namespace OneDrive
+{
+/**
+ * Keeps released byte buffers around so streaming code doesn't allocate a new block for every read.
+ *
+ * A buffer that is still shared when released (e.g. because a consumer kept a copy of a chunk)
+ * is dropped rather than reused, so handing pooled buffers out by value is safe.
+ */
+class BufferPool
+{
+public:
+    explicit BufferPool(qsizetype maxRetainedBytes);
+
+    /**
+     * @return An empty buffer with room for at least @p capacity bytes.
+     */
+    [[nodiscard]] QByteArray acquire(qsizetype capacity);
+
+    void release(QByteArray &&buffer);
+
+    /**
+     * Frees all retained buffers.
+     */
+    void clear();
+
+private:
+    QList<QByteArray> m_free;
+    qsizetype m_retainedBytes = 0;
+    qsizetype m_maxRetainedBytes;
+};
+}
@@ -0,0 +1,95 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "foldermodel.h"
+
+#include <optional>
+
+bool FolderModel::hasFolder(const QString &folderId) const
+{
+    return m_children.contains(folderId);
+}
+
+QList<OneDrive::DriveItem> FolderModel::children(const QString &folderId) const
+{
+    return m_children.value(folderId).values();
+}
+
+void FolderModel::setChildren(const QString &folderId, const QList<OneDrive::DriveItem> &items)
+{
+    removeFolder(folderId);
+
+    auto &children = m_children[folderId];
+    for (const auto &item : items) {
+        children.insert(item.id, item);
+        m_parents.insert(item.id, folderId);
+    }
+}
+
+QStringList FolderModel::applyDelta(const QList<OneDrive::DriveItem> &changes)
+{
+    QStringList relocated;
+    for (const auto &change : changes) {
+        // Moves show up as an update with a new parent, so always detach from the old one first.
+        std::optional<OneDrive::DriveItem> previous;
+        if (const auto it = m_parents.constFind(change.id); it != m_parents.cend()) {
+            const auto childrenIt = m_children.find(*it);
+            if (childrenIt != m_children.end()) {
+                previous = childrenIt->take(change.id);
+            }
+            m_parents.erase(it);
+        }
+
+        // The drive root has no parent and never moves.
+        const bool unknownFolderChanged = !previous && !change.parentId.isEmpty() && m_children.contains(change.id);
+        if (change.deleted || unknownFolderChanged || (previous && (previous->name != change.name || previous->parentId != change.parentId))) {
+            relocated.append(change.id);
+        }
+
+        if (change.deleted) {
+            removeFolder(change.id);
+            continue;
+        }
+
+        const auto childrenIt = m_children.find(change.parentId);
+        if (childrenIt == m_children.end()) {
+            continue;
+        }
+        childrenIt->insert(change.id, change);
+        m_parents.insert(change.id, change.parentId);
+    }
+    return relocated;
+}
+
+void FolderModel::clear()
+{
+    m_children.clear();
+    m_parents.clear();
+    m_deltaLink.clear();
+}
+
+QString FolderModel::deltaLink() const
+{
+    return m_deltaLink;
+}
+
+void FolderModel::setDeltaLink(const QString &deltaLink)
+{
+    m_deltaLink = deltaLink;
+}
+
+void FolderModel::removeFolder(const QString &folderId)
+{
+    const auto it = m_children.constFind(folderId);
+    if (it == m_children.cend()) {
+        return;
+    }
+
+    for (auto childIt = it->cbegin(); childIt != it->cend(); ++childIt) {
+        m_parents.remove(childIt.key());
+    }
+    m_children.erase(it);
+}
@@ -0,0 +1,49 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include "graphjson.h"
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+/**
+ * In-memory copy of the folders of a drive that have been listed so far.
+ *
+ * Folders are filled by a full listing once and then kept up to date by applying
+ * the changes reported by the Graph delta endpoint since deltaLink().
+ */
+class FolderModel
+{
+public:
+    bool hasFolder(const QString &folderId) const;
+    QList<OneDrive::DriveItem> children(const QString &folderId) const;
+    void setChildren(const QString &folderId, const QList<OneDrive::DriveItem> &items);
+
+    /**
+     * Applies the changed items of a delta page. Items whose parent folder is not
+     * part of the model are ignored.
+     *
+     * @return The ids of items that were renamed, moved or deleted, so paths that led to
+     * them or anything below them are stale now. Folders of the model whose old name
+     * isn't known are included whenever they change.
+     */
+    [[nodiscard]] QStringList applyDelta(const QList<OneDrive::DriveItem> &changes);
+    void clear();
+
+    QString deltaLink() const;
+    void setDeltaLink(const QString &deltaLink);
+
+private:
+    void removeFolder(const QString &folderId);
+
+    QHash<QString /* folderId */, QHash<QString /* itemId */, OneDrive::DriveItem>> m_children;
+    QHash<QString /* itemId */, QString /* folderId */> m_parents;
+    QString m_deltaLink;
+};
@@ -0,0 +1,229 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "graphbatch.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSet>
+
+#include <algorithm>
+#include <functional>
+
+using namespace OneDrive;
+
+namespace
+{
+// Throttled sub-requests without a Retry-After wait this long, doubled with every attempt.
+constexpr qint64 InitialThrottleDelayMs = 1000;
+
+const QString MimeApplicationJson = QStringLiteral("application/json");
+
+bool isSuccessStatus(int httpStatus)
+{
+    return httpStatus >= 200 && httpStatus < 300;
+}
+
+bool isThrottledStatus(int httpStatus)
+{
+    return httpStatus == 429 || httpStatus == 503;
+}
+} // namespace
+
+BatchPlan::BatchPlan(const QList<BatchRequest> &requests)
+    : m_requests(requests)
+    , m_attempts(requests.size(), 0)
+{
+    QHash<QString, qsizetype> indexById;
+    for (qsizetype i = 0; i < requests.size(); ++i) {
+        if (requests.at(i).id.isEmpty() || indexById.contains(requests.at(i).id)) {
+            m_error = QStringLiteral("Batched requests need unique, non-empty ids");
+            return;
+        }
+        indexById.insert(requests.at(i).id, i);
+    }
+
+    // Order requests so that every request comes after the ones it depends on.
+    QList<int> visitState(requests.size(), 0);
+    std::function<bool(qsizetype)> visit = [&](qsizetype index) {
+        if (visitState.at(index) == 2) {
+            return true;
+        }
+        if (visitState.at(index) == 1) {
+            return false;
+        }
+        visitState[index] = 1;
+        for (const QString &dependency : requests.at(index).dependsOn) {
+            const auto it = indexById.constFind(dependency);
+            if (it == indexById.cend() || !visit(*it)) {
+                return false;
+            }
+        }
+        visitState[index] = 2;
+        m_order.append(index);
+        return true;
+    };
+    for (qsizetype i = 0; i < requests.size(); ++i) {
+        if (!visit(i)) {
+            m_error = QStringLiteral("Batched request %1 has an unknown or circular dependency").arg(requests.at(i).id);
+            m_order.clear();
+            return;
+        }
+    }
+
+    for (qsizetype position = 0; position < m_order.size(); ++position) {
+        m_pending.append(position);
+    }
+}
+
+QString BatchPlan::error() const
+{
+    return m_error;
+}
+
+bool BatchPlan::hasPending() const
+{
+    return !m_pending.isEmpty();
+}
+
+QByteArray BatchPlan::nextPayload()
+{
+    m_sent.clear();
+    QSet<QString> sentIds;
+    QJsonArray payloadRequests;
+
+    const QList<qsizetype> batch = m_pending.first(std::min(MaxBatchSize, m_pending.size()));
+    m_pending.remove(0, batch.size());
+    for (const qsizetype position : batch) {
+        const qsizetype index = m_order.at(position);
+        const BatchRequest &request = m_requests.at(index);
+
+        // Dependencies in this round trip are left to Graph. Anything else has already completed,
+        // so we only need to check that it succeeded.
+        QJsonArray dependsOn;
+        bool dependencyFailed = false;
+        for (const QString &dependency : request.dependsOn) {
+            if (sentIds.contains(dependency)) {
+                dependsOn.append(dependency);
+            } else if (!isSuccessStatus(m_responses.value(dependency).httpStatus)) {
+                dependencyFailed = true;
+            }
+        }
+        if (dependencyFailed) {
+            m_responses.insert(request.id, BatchResponse{request.id, 424, QJsonObject()});
+            continue;
+        }
+
+        QJsonObject subRequest;
+        subRequest.insert(QStringLiteral("id"), request.id);
+        subRequest.insert(QStringLiteral("method"), QString::fromLatin1(request.method));
+        subRequest.insert(QStringLiteral("url"), request.url);
+        if (!request.body.isEmpty()) {
+            subRequest.insert(QStringLiteral("body"), request.body);
+            QJsonObject headers;
+            headers.insert(QStringLiteral("Content-Type"), MimeApplicationJson);
+            subRequest.insert(QStringLiteral("headers"), headers);
+        }
+        if (!dependsOn.isEmpty()) {
+            subRequest.insert(QStringLiteral("dependsOn"), dependsOn);
+        }
+        payloadRequests.append(subRequest);
+        sentIds.insert(request.id);
+        m_sent.append(position);
+        ++m_attempts[index];
+    }
+
+    if (payloadRequests.isEmpty()) {
+        return QByteArray();
+    }
+
+    QJsonObject payload;
+    payload.insert(QStringLiteral("requests"), payloadRequests);
+    return QJsonDocument(payload).toJson(QJsonDocument::Compact);
+}
+
+qint64 BatchPlan::applyReply(const QByteArray &reply)
+{
+    m_requeued.clear();
+    qint64 delayMs = 0;
+    QSet<QString> throttledIds;
+
+    const QJsonArray values = QJsonDocument::fromJson(reply).object().value(QStringLiteral("responses")).toArray();
+    for (const QJsonValue &value : values) {
+        const QJsonObject responseObj = value.toObject();
+        BatchResponse response;
+        response.id = responseObj.value(QStringLiteral("id")).toString();
+        response.httpStatus = responseObj.value(QStringLiteral("status")).toInt();
+        response.body = responseObj.value(QStringLiteral("body")).toObject();
+        m_responses.insert(response.id, response);
+
+        if (!isThrottledStatus(response.httpStatus)) {
+            continue;
+        }
+        const auto sent = std::find_if(m_sent.cbegin(), m_sent.cend(), [&](qsizetype position) {
+            return m_requests.at(m_order.at(position)).id == response.id;
+        });
+        if (sent == m_sent.cend() || m_attempts.at(m_order.at(*sent)) >= MaxThrottledAttempts) {
+            continue;
+        }
+
+        throttledIds.insert(response.id);
+        bool hasRetryAfter = false;
+        const QJsonObject headers = responseObj.value(QStringLiteral("headers")).toObject();
+        const qint64 retryAfterSecs = headers.value(QStringLiteral("Retry-After")).toVariant().toLongLong(&hasRetryAfter);
+        const int attempts = m_attempts.at(m_order.at(*sent));
+        delayMs = std::max(delayMs, hasRetryAfter ? retryAfterSecs * 1000 : InitialThrottleDelayMs << (attempts - 1));
+    }
+
+    if (throttledIds.isEmpty()) {
+        return 0;
+    }
+
+    // Requests sent along with a throttled dependency failed because of it and go again, too.
+    // m_sent is in dependency order, so dependencies are seen before what depends on them.
+    QList<qsizetype> requeued;
+    for (const qsizetype position : std::as_const(m_sent)) {
+        const BatchRequest &request = m_requests.at(m_order.at(position));
+        const bool dependsOnThrottled = std::any_of(request.dependsOn.cbegin(), request.dependsOn.cend(), [&](const QString &dependency) {
+            return throttledIds.contains(dependency);
+        });
+        if (throttledIds.contains(request.id) || (dependsOnThrottled && !isSuccessStatus(m_responses.value(request.id).httpStatus))) {
+            throttledIds.insert(request.id);
+            requeued.append(position);
+        }
+    }
+    requeue(requeued);
+    return delayMs;
+}
+
+void BatchPlan::requeue(const QList<qsizetype> &positions)
+{
+    // Everything sent comes before everything still pending in dependency order, so prepending keeps it.
+    m_pending = positions + m_pending;
+    m_requeued = positions;
+}
+
+void BatchPlan::dropThrottled()
+{
+    m_pending.removeIf([this](qsizetype position) {
+        return m_requeued.contains(position);
+    });
+    m_requeued.clear();
+}
+
+QList<BatchResponse> BatchPlan::responses() const
+{
+    QList<BatchResponse> responses;
+    for (const BatchRequest &request : m_requests) {
+        BatchResponse response = m_responses.value(request.id);
+        if (response.id.isEmpty()) {
+            response.id = request.id;
+            response.httpStatus = 500;
+        }
+        responses.append(response);
+    }
+    return responses;
+}
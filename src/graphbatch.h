@@ -0,0 +1,98 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+namespace OneDrive
+{
+/**
+ * One sub-request of a JSON $batch call. @p url is relative to the Graph version root,
+ * e.g. "/me/drive/items/{id}", and @p dependsOn lists ids of requests that must complete first.
+ */
+struct BatchRequest {
+    QString id;
+    QByteArray method;
+    QString url;
+    QJsonObject body;
+    QStringList dependsOn;
+};
+
+struct BatchResponse {
+    QString id;
+    int httpStatus = 0;
+    QJsonObject body;
+};
+
+/**
+ * Splits the requests of a $batch call into round trips and collects their responses.
+ *
+ * Requests are sent in an order that puts every request after the ones it depends on, up to
+ * MaxBatchSize per round trip. A request whose dependency failed in an earlier round trip gets
+ * a 424 response without being sent. Throttled sub-requests (429, 503) are queued again, with
+ * the requests that failed only because they depended on them.
+ */
+class BatchPlan
+{
+public:
+    static constexpr qsizetype MaxBatchSize = 20;
+    static constexpr int MaxThrottledAttempts = 5;
+
+    explicit BatchPlan(const QList<BatchRequest> &requests);
+
+    /**
+     * @return Why the requests can't be sent (duplicate or empty ids, unknown or circular
+     * dependencies), or an empty string.
+     */
+    [[nodiscard]] QString error() const;
+
+    [[nodiscard]] bool hasPending() const;
+
+    /**
+     * @return The JSON body of the next round trip, empty if every remaining request was answered
+     * without being sent.
+     */
+    [[nodiscard]] QByteArray nextPayload();
+
+    /**
+     * Records the responses to the last nextPayload().
+     * @return How long to wait before the next round trip, as asked for by throttled sub-requests
+     * through Retry-After, 0 if none were throttled.
+     */
+    qint64 applyReply(const QByteArray &reply);
+
+    /**
+     * Stops retrying the requests the last applyReply() queued again, they keep the response they
+     * got, e.g. 429. Requests that were never sent stay pending.
+     */
+    void dropThrottled();
+
+    /**
+     * @return One response per request, in the order they were given. Requests that never got
+     * one are answered with 500.
+     */
+    [[nodiscard]] QList<BatchResponse> responses() const;
+
+private:
+    void requeue(const QList<qsizetype> &positions);
+
+    QList<BatchRequest> m_requests;
+    QString m_error;
+    // Request indexes in dependency order, and the positions in it that still have to be sent.
+    QList<qsizetype> m_order;
+    QList<qsizetype> m_pending;
+    QList<qsizetype> m_sent;
+    QList<qsizetype> m_requeued;
+    QList<int> m_attempts;
+    QHash<QString, BatchResponse> m_responses;
+};
+}
@@ -0,0 +1,485 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "graphjson.h"
+
+#include <string_view>
+#include <utility>
+
+using namespace OneDrive;
+
+namespace
+{
+const QString MimeDirectory = QStringLiteral("inode/directory");
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+// Minimal pull reader over UTF-8 JSON. Callers drive it with the structure they expect and
+// skip everything else; the first syntax error makes every further call fail.
+class Reader
+{
+public:
+    explicit Reader(const QByteArray &data)
+        : m_pos(data.constData())
+        , m_end(data.constData() + data.size())
+    {
+    }
+
+    [[nodiscard]] bool failed() const
+    {
+        return m_failed;
+    }
+
+    [[nodiscard]] bool atEnd()
+    {
+        skipSpaces();
+        return m_pos == m_end;
+    }
+
+    [[nodiscard]] bool nextIs(char c)
+    {
+        skipSpaces();
+        return m_pos < m_end && *m_pos == c;
+    }
+
+    // Calls onMember with each key, onMember has to consume the value.
+    template<typename Callback>
+    bool readObject(Callback &&onMember)
+    {
+        if (!consume('{')) {
+            return fail();
+        }
+        if (consume('}')) {
+            return true;
+        }
+        do {
+            std::string_view key;
+            if (!readKey(key) || !consume(':')) {
+                return fail();
+            }
+            onMember(key);
+            if (m_failed) {
+                return false;
+            }
+        } while (consume(','));
+        return consume('}') || fail();
+    }
+
+    // Calls onElement for each element, onElement has to consume it.
+    template<typename Callback>
+    bool readArray(Callback &&onElement)
+    {
+        if (!consume('[')) {
+            return fail();
+        }
+        if (consume(']')) {
+            return true;
+        }
+        do {
+            onElement();
+            if (m_failed) {
+                return false;
+            }
+        } while (consume(','));
+        return consume(']') || fail();
+    }
+
+    // Objects where Graph may also send null.
+    template<typename Callback>
+    bool readObjectOrSkip(Callback &&onMember)
+    {
+        return nextIs('{') ? readObject(std::forward<Callback>(onMember)) : skipValue();
+    }
+
+    QString readString()
+    {
+        if (!nextIs('"')) {
+            skipValue();
+            return QString();
+        }
+        ++m_pos;
+
+        const char *start = m_pos;
+        while (m_pos < m_end && *m_pos != '"' && *m_pos != '\\') {
+            ++m_pos;
+        }
+        if (m_pos < m_end && *m_pos == '"') {
+            return QString::fromUtf8(start, m_pos++ - start);
+        }
+
+        // Escape sequences are rare in Graph payloads, only decode piecewise when there are some.
+        QString result = QString::fromUtf8(start, m_pos - start);
+        while (m_pos < m_end) {
+            if (*m_pos == '"') {
+                ++m_pos;
+                return result;
+            }
+            if (*m_pos != '\\') {
+                const char *run = m_pos;
+                while (m_pos < m_end && *m_pos != '"' && *m_pos != '\\') {
+                    ++m_pos;
+                }
+                result += QString::fromUtf8(run, m_pos - run);
+                continue;
+            }
+            if (++m_pos == m_end) {
+                break;
+            }
+            switch (*m_pos++) {
+            case '"':
+                result += QLatin1Char('"');
+                break;
+            case '\\':
+                result += QLatin1Char('\\');
+                break;
+            case '/':
+                result += QLatin1Char('/');
+                break;
+            case 'b':
+                result += QLatin1Char('\b');
+                break;
+            case 'f':
+                result += QLatin1Char('\f');
+                break;
+            case 'n':
+                result += QLatin1Char('\n');
+                break;
+            case 'r':
+                result += QLatin1Char('\r');
+                break;
+            case 't':
+                result += QLatin1Char('\t');
+                break;
+            case 'u': {
+                bool ok = false;
+                const ushort unit = m_end - m_pos >= 4 ? QByteArray::fromRawData(m_pos, 4).toUShort(&ok, 16) : 0;
+                if (!ok) {
+                    fail();
+                    return QString();
+                }
+                // Surrogate pairs arrive as two escapes, appending both units reassembles them.
+                result += QChar(unit);
+                m_pos += 4;
+                break;
+            }
+            default:
+                fail();
+                return QString();
+            }
+        }
+        fail();
+        return QString();
+    }
+
+    double readNumber()
+    {
+        skipSpaces();
+        const char *start = m_pos;
+        while (m_pos < m_end && isNumberChar(*m_pos)) {
+            ++m_pos;
+        }
+        if (m_pos == start) {
+            skipValue();
+            return 0;
+        }
+        return QByteArray::fromRawData(start, m_pos - start).toDouble();
+    }
+
+    bool skipValue()
+    {
+        skipSpaces();
+        if (m_pos == m_end) {
+            return fail();
+        }
+        switch (*m_pos) {
+        case '"':
+            return skipString();
+        case '{':
+            return readObject([this](std::string_view) {
+                skipValue();
+            });
+        case '[':
+            return readArray([this]() {
+                skipValue();
+            });
+        default: {
+            // Numbers and the true/false/null literals.
+            const char *start = m_pos;
+            while (m_pos < m_end && (isNumberChar(*m_pos) || (*m_pos >= 'a' && *m_pos <= 'z'))) {
+                ++m_pos;
+            }
+            return m_pos != start || fail();
+        }
+        }
+    }
+
+private:
+    const char *m_pos;
+    const char *m_end;
+    bool m_failed = false;
+
+    static bool isNumberChar(char c)
+    {
+        return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    }
+
+    bool fail()
+    {
+        m_failed = true;
+        m_pos = m_end;
+        return false;
+    }
+
+    void skipSpaces()
+    {
+        while (m_pos < m_end && isSpace(*m_pos)) {
+            ++m_pos;
+        }
+    }
+
+    bool consume(char c)
+    {
+        if (nextIs(c)) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool skipString()
+    {
+        ++m_pos;
+        while (m_pos < m_end && *m_pos != '"') {
+            m_pos += *m_pos == '\\' && m_end - m_pos > 1 ? 2 : 1;
+        }
+        if (m_pos >= m_end) {
+            return fail();
+        }
+        ++m_pos;
+        return true;
+    }
+
+    // Graph keys never need unescaping, escaped ones simply match nothing we look for.
+    bool readKey(std::string_view &key)
+    {
+        if (!nextIs('"')) {
+            return false;
+        }
+        const char *start = ++m_pos;
+        while (m_pos < m_end && *m_pos != '"') {
+            m_pos += *m_pos == '\\' && m_end - m_pos > 1 ? 2 : 1;
+        }
+        if (m_pos >= m_end) {
+            return false;
+        }
+        key = std::string_view(start, m_pos++ - start);
+        return true;
+    }
+};
+
+QString readDisplayName(Reader &reader)
+{
+    QString displayName;
+    reader.readObjectOrSkip([&](std::string_view key) {
+        if (key != "user") {
+            reader.skipValue();
+            return;
+        }
+        reader.readObjectOrSkip([&](std::string_view userKey) {
+            if (userKey == "displayName") {
+                displayName = reader.readString();
+            } else {
+                reader.skipValue();
+            }
+        });
+    });
+    return displayName;
+}
+
+// Mirrors parseDriveItem(). The remoteItem facet is decoded completely into remote, if given.
+// Returns false for an empty (or null) object.
+bool readItem(Reader &reader, DriveItem &item, DriveItem *remote = nullptr)
+{
+    bool hasMembers = false;
+    bool hasFileFacet = false;
+    QString fileMimeType;
+    bool hasRemote = false;
+    DriveItem remoteItem;
+
+    reader.readObjectOrSkip([&](std::string_view key) {
+        hasMembers = true;
+        if (key == "id") {
+            item.id = reader.readString();
+        } else if (key == "name") {
+            item.name = reader.readString();
+        } else if (key == "size") {
+            item.size = static_cast<qint64>(reader.readNumber());
+        } else if (key == "lastModifiedDateTime") {
+            item.lastModified = QDateTime::fromString(reader.readString(), Qt::ISODate);
+        } else if (key == "createdDateTime") {
+            item.createdTime = QDateTime::fromString(reader.readString(), Qt::ISODate);
+        } else if (key == "folder") {
+            item.isFolder = true;
+            reader.skipValue();
+        } else if (key == "deleted") {
+            item.deleted = true;
+            reader.skipValue();
+        } else if (key == "@microsoft.graph.downloadUrl") {
+            item.downloadUrl = reader.readString();
+        } else if (key == "webUrl") {
+            item.webUrl = reader.readString();
+        } else if (key == "eTag") {
+            item.eTag = reader.readString();
+        } else if (key == "cTag") {
+            item.cTag = reader.readString();
+        } else if (key == "createdBy") {
+            item.createdBy = readDisplayName(reader);
+        } else if (key == "lastModifiedBy") {
+            item.lastModifiedBy = readDisplayName(reader);
+        } else if (key == "parentReference") {
+            reader.readObjectOrSkip([&](std::string_view parentKey) {
+                if (parentKey == "id") {
+                    item.parentId = reader.readString();
+                } else if (parentKey == "path") {
+                    item.parentPath = reader.readString();
+                } else if (parentKey == "driveId") {
+                    item.driveId = reader.readString();
+                } else {
+                    reader.skipValue();
+                }
+            });
+        } else if (key == "file") {
+            reader.readObjectOrSkip([&](std::string_view fileKey) {
+                hasFileFacet = true;
+                if (fileKey == "mimeType") {
+                    fileMimeType = reader.readString();
+                } else if (fileKey == "hashes") {
+                    reader.readObjectOrSkip([&](std::string_view hashKey) {
+                        if (hashKey == "quickXorHash") {
+                            item.quickXorHash = reader.readString();
+                        } else if (hashKey == "sha1Hash") {
+                            item.sha1Hash = reader.readString();
+                        } else {
+                            reader.skipValue();
+                        }
+                    });
+                } else {
+                    reader.skipValue();
+                }
+            });
+        } else if (key == "remoteItem") {
+            hasRemote = readItem(reader, remoteItem);
+        } else {
+            reader.skipValue();
+        }
+    });
+
+    if (hasFileFacet) {
+        item.mimeType = fileMimeType;
+    } else if (item.isFolder) {
+        item.mimeType = MimeDirectory;
+    }
+    if (hasRemote) {
+        item.remoteDriveId = remoteItem.driveId;
+        item.remoteItemId = remoteItem.id;
+        if (remote) {
+            *remote = std::move(remoteItem);
+        }
+    }
+    return hasMembers;
+}
+} // namespace
+
+ListPage OneDrive::parseListPage(const QByteArray &payload, ListItemSource source)
+{
+    ListPage page;
+    Reader reader(payload);
+
+    auto readEntry = [&]() {
+        DriveItem item;
+        if (source == ListItemSource::Item) {
+            readItem(reader, item);
+            page.items.append(std::move(item));
+            return;
+        }
+
+        DriveItem remote;
+        readItem(reader, item, &remote);
+        remote.remoteDriveId = remote.driveId;
+        remote.remoteItemId = remote.id;
+        remote.id = item.id;
+        page.items.append(std::move(remote));
+    };
+
+    const bool parsed = reader.readObject([&](std::string_view key) {
+        if (key == "value") {
+            if (reader.nextIs('[')) {
+                reader.readArray(readEntry);
+            } else {
+                reader.skipValue();
+            }
+        } else if (key == "@odata.nextLink") {
+            page.nextLink = reader.readString();
+        } else if (key == "@odata.deltaLink") {
+            page.deltaLink = reader.readString();
+        } else {
+            reader.skipValue();
+        }
+    });
+
+    page.valid = parsed && !reader.failed() && reader.atEnd();
+    return page;
+}
+
+DriveItem OneDrive::parseDriveItem(const QJsonObject &object)
+{
+    DriveItem item;
+    item.id = object.value(QStringLiteral("id")).toString();
+    item.name = object.value(QStringLiteral("name")).toString();
+    item.size = static_cast<qint64>(object.value(QStringLiteral("size")).toDouble());
+    item.lastModified = QDateTime::fromString(object.value(QStringLiteral("lastModifiedDateTime")).toString(), Qt::ISODate);
+    item.createdTime = QDateTime::fromString(object.value(QStringLiteral("createdDateTime")).toString(), Qt::ISODate);
+    item.isFolder = object.contains(QStringLiteral("folder"));
+    item.deleted = object.contains(QStringLiteral("deleted"));
+    item.downloadUrl = object.value(QStringLiteral("@microsoft.graph.downloadUrl")).toString();
+    item.webUrl = object.value(QStringLiteral("webUrl")).toString();
+    item.eTag = object.value(QStringLiteral("eTag")).toString();
+    item.cTag = object.value(QStringLiteral("cTag")).toString();
+
+    if (const auto createdByObj = object.value(QStringLiteral("createdBy")).toObject(); !createdByObj.isEmpty()) {
+        const auto userObj = createdByObj.value(QStringLiteral("user")).toObject();
+        item.createdBy = userObj.value(QStringLiteral("displayName")).toString();
+    }
+    if (const auto lastModifiedByObj = object.value(QStringLiteral("lastModifiedBy")).toObject(); !lastModifiedByObj.isEmpty()) {
+        const auto userObj = lastModifiedByObj.value(QStringLiteral("user")).toObject();
+        item.lastModifiedBy = userObj.value(QStringLiteral("displayName")).toString();
+    }
+
+    const QJsonObject parent = object.value(QStringLiteral("parentReference")).toObject();
+    item.parentId = parent.value(QStringLiteral("id")).toString();
+    item.parentPath = parent.value(QStringLiteral("path")).toString();
+    item.driveId = parent.value(QStringLiteral("driveId")).toString();
+
+    if (const QJsonObject remoteItem = object.value(QStringLiteral("remoteItem")).toObject(); !remoteItem.isEmpty()) {
+        const QJsonObject remoteParent = remoteItem.value(QStringLiteral("parentReference")).toObject();
+        item.remoteDriveId = remoteParent.value(QStringLiteral("driveId")).toString();
+        item.remoteItemId = remoteItem.value(QStringLiteral("id")).toString();
+    }
+
+    if (const QJsonObject fileObj = object.value(QStringLiteral("file")).toObject(); !fileObj.isEmpty()) {
+        item.mimeType = fileObj.value(QStringLiteral("mimeType")).toString();
+        const QJsonObject hashes = fileObj.value(QStringLiteral("hashes")).toObject();
+        item.quickXorHash = hashes.value(QStringLiteral("quickXorHash")).toString();
+        item.sha1Hash = hashes.value(QStringLiteral("sha1Hash")).toString();
+    } else if (item.isFolder) {
+        item.mimeType = MimeDirectory;
+    }
+
+    return item;
+}
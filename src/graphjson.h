@@ -0,0 +1,71 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+
+namespace OneDrive
+{
+struct DriveItem {
+    QString id;
+    QString name;
+    QString parentId;
+    QString parentPath;
+    QString driveId;
+    QString remoteDriveId;
+    QString remoteItemId;
+    QString mimeType;
+    QString downloadUrl;
+    QString webUrl;
+    QString eTag;
+    QString cTag;
+    // From the file facet's hashes, quickXorHash in Base64 and sha1Hash in hex. Business drives only publish quickXorHash.
+    QString quickXorHash;
+    QString sha1Hash;
+    QString createdBy;
+    QString lastModifiedBy;
+    QDateTime createdTime;
+    bool isFolder = false;
+    bool deleted = false;
+    qint64 size = 0;
+    QDateTime lastModified;
+};
+
+/**
+ * Which part of a collection entry describes the item.
+ */
+enum class ListItemSource {
+    Item,
+    /// The entry's remoteItem facet, as in sharedWithMe. The entry's own id is kept as DriveItem::id,
+    /// the remote drive and item ids go to DriveItem::remoteDriveId and DriveItem::remoteItemId.
+    RemoteItem,
+};
+
+struct ListPage {
+    bool valid = false;
+    QString nextLink;
+    QString deltaLink;
+    QList<DriveItem> items;
+};
+
+/**
+ * @return The driveItem described by @p object.
+ */
+[[nodiscard]] DriveItem parseDriveItem(const QJsonObject &object);
+
+/**
+ * Decodes a Graph collection page (value, @odata.nextLink, @odata.deltaLink) in a single pass over
+ * @p payload, straight into DriveItems and without building a QJsonDocument. Members that are
+ * not needed for a DriveItem are skipped without being decoded.
+ * @return The page, with ListPage::valid false if @p payload is not a JSON object.
+ */
+[[nodiscard]] ListPage parseListPage(const QByteArray &payload, ListItemSource source = ListItemSource::Item);
+}
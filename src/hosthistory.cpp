@@ -0,0 +1,65 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "hosthistory.h"
+#include "onedrivedebug.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+HostHistory::HostHistory(const QString &filePath, qsizetype maxHosts)
+    : m_filePath(filePath)
+    , m_maxHosts(maxHosts)
+{
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return;
+    }
+    while (!file.atEnd() && m_hosts.size() < m_maxHosts) {
+        const QString host = QString::fromUtf8(file.readLine()).trimmed();
+        if (!host.isEmpty() && !m_hosts.contains(host)) {
+            m_hosts.append(host);
+        }
+    }
+}
+
+QStringList HostHistory::hosts() const
+{
+    return m_hosts;
+}
+
+void HostHistory::recordHost(const QString &host)
+{
+    if (host.isEmpty() || (!m_hosts.isEmpty() && m_hosts.constFirst() == host)) {
+        return;
+    }
+
+    m_hosts.removeAll(host);
+    m_hosts.prepend(host);
+    if (m_hosts.size() > m_maxHosts) {
+        m_hosts.resize(m_maxHosts);
+    }
+    save();
+}
+
+void HostHistory::save() const
+{
+    if (m_filePath.isEmpty() || !QDir().mkpath(QFileInfo(m_filePath).path())) {
+        return;
+    }
+
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qCWarning(ONEDRIVE) << "Cannot write" << m_filePath << file.errorString();
+        return;
+    }
+    file.write(m_hosts.join(QLatin1Char('\n')).toUtf8() + '\n');
+    if (!file.commit()) {
+        qCWarning(ONEDRIVE) << "Cannot write" << m_filePath << file.errorString();
+    }
+}
@@ -0,0 +1,34 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * Most recently used hosts, newest first, kept in a small text file so that they survive
+ * the worker process.
+ */
+class HostHistory
+{
+public:
+    HostHistory(const QString &filePath, qsizetype maxHosts);
+
+    QStringList hosts() const;
+
+    /**
+     * Moves @p host to the front, writing the file if that changed anything.
+     */
+    void recordHost(const QString &host);
+
+private:
+    void save() const;
+
+    QString m_filePath;
+    qsizetype m_maxHosts;
+    QStringList m_hosts;
+};
@@ -0,0 +1,75 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "itemcache.h"
+
+namespace
+{
+// Listing a huge folder shouldn't leave all of it in memory; expired entries are dropped past this size.
+constexpr qsizetype MaxCachedItems = 10000;
+
+QString normalizedPath(const QString &path)
+{
+    QString normalized = path.startsWith(QLatin1Char('/')) ? path.mid(1) : path;
+    while (normalized.endsWith(QLatin1Char('/'))) {
+        normalized.chop(1);
+    }
+    return normalized;
+}
+} // namespace
+
+ItemCache::ItemCache(qint64 ttlMs)
+    : m_ttlMs(ttlMs)
+{
+}
+
+void ItemCache::insert(const QString &path, const OneDrive::DriveItem &item)
+{
+    // Only drop what was cached for this exact path, listings insert every child and purging
+    // below each folder would walk the whole cache every time.
+    if (item.isFolder || item.downloadUrl.isEmpty()) {
+        m_items.remove(normalizedPath(path));
+        return;
+    }
+
+    if (m_items.size() >= MaxCachedItems) {
+        removeExpired();
+        if (m_items.size() >= MaxCachedItems) {
+            m_items.clear();
+        }
+    }
+    m_items.insert(normalizedPath(path), Entry{item, QDeadlineTimer(m_ttlMs)});
+}
+
+std::optional<OneDrive::DriveItem> ItemCache::item(const QString &path) const
+{
+    const auto it = m_items.constFind(normalizedPath(path));
+    if (it == m_items.constEnd() || it->expiry.hasExpired()) {
+        return std::nullopt;
+    }
+    return it->item;
+}
+
+void ItemCache::remove(const QString &path)
+{
+    const QString key = normalizedPath(path);
+    const QString prefix = key + QLatin1Char('/');
+    m_items.removeIf([&](const auto &entry) {
+        return entry.key() == key || entry.key().startsWith(prefix);
+    });
+}
+
+void ItemCache::clear()
+{
+    m_items.clear();
+}
+
+void ItemCache::removeExpired()
+{
+    m_items.removeIf([](const auto &entry) {
+        return entry.value().expiry.hasExpired();
+    });
+}
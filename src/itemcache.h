@@ -0,0 +1,52 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include "graphjson.h"
+
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QString>
+
+#include <optional>
+
+/**
+ * Recently seen files by path, so that get() can go straight to their pre-authenticated
+ * download URL without asking Graph for the item again.
+ *
+ * Graph only promises that @microsoft.graph.downloadUrl stays valid for a short while, so
+ * entries expire well before that and only files with a download URL are kept at all.
+ */
+class ItemCache
+{
+public:
+    explicit ItemCache(qint64 ttlMs);
+
+    void insert(const QString &path, const OneDrive::DriveItem &item);
+
+    /**
+     * @return The item last seen at @p path, unless it has expired.
+     */
+    [[nodiscard]] std::optional<OneDrive::DriveItem> item(const QString &path) const;
+
+    /**
+     * Forgets @p path and, if it is a folder, everything below it.
+     */
+    void remove(const QString &path);
+    void clear();
+
+private:
+    struct Entry {
+        OneDrive::DriveItem item;
+        QDeadlineTimer expiry;
+    };
+
+    void removeExpired();
+
+    QHash<QString /* path */, Entry> m_items;
+    qint64 m_ttlMs;
+};
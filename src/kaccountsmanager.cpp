@@ -14,8 +14,11 @@
 #include <Accounts/Provider>
 #include <KAccounts/Core>
 #include <KAccounts/GetCredentialsJob>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QProcess>
 #include <QStandardPaths>
+#include <QTimeZone>
 
 KAccountsManager::KAccountsManager()
 {
@@ -78,9 +81,9 @@ OneDriveAccountPtr KAccountsManager::refreshAccount(const OneDriveAccountPtr &ac
 
         const auto id = it.key();
         qCDebug(ONEDRIVE) << "Refreshing" << accountName;
-        auto cloudAccount = getAccountCredentials(id, accountName);
-        m_accounts.insert(id, cloudAccount);
-        return cloudAccount;
+        // Update in place, so that whoever still holds the account sends the new token from now on.
+        *it.value() = *getAccountCredentials(id, accountName);
+        return it.value();
     }
 
     return {};
@@ -159,6 +162,21 @@ static QString elideToken(const QString &token)
     return token.left(4) + QStringLiteral("...") + token.right(4);
 }
 
+// Work and school accounts get JWT access tokens, which carry their expiry in the exp claim.
+static QDateTime jwtExpiry(const QString &token)
+{
+    const QStringList parts = token.split(QLatin1Char('.'));
+    if (parts.size() != 3) {
+        return {};
+    }
+    const auto payload = QByteArray::fromBase64Encoding(parts.at(1).toLatin1(), QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+    if (!payload) {
+        return {};
+    }
+    const qint64 exp = QJsonDocument::fromJson(*payload).object().value(QStringLiteral("exp")).toInteger();
+    return exp > 0 ? QDateTime::fromSecsSinceEpoch(exp, QTimeZone::UTC) : QDateTime();
+}
+
 OneDriveAccountPtr KAccountsManager::getAccountCredentials(Accounts::AccountId id, const QString &displayName) const
 {
     auto job = std::make_unique<KAccounts::GetCredentialsJob>(id, nullptr);
@@ -173,8 +191,23 @@ OneDriveAccountPtr KAccountsManager::getAccountCredentials(Accounts::AccountId i
     cloudAccount->refresh = job->credentialsData().value(QStringLiteral("RefreshToken")).toString();
     cloudAccount->scopes = job->credentialsData().value(QStringLiteral("Scope")).toStringList();
 
+    // ExpiresIn counts from when the token was issued, not from now: a cached token may be well into
+    // its lifetime already. It is only used together with the time the token was stored. Without
+    // either, there is no proactive refresh and a 401 triggers the refresh instead.
+    cloudAccount->expiresAt = jwtExpiry(cloudAccount->token);
+    if (!cloudAccount->expiresAt.isValid()) {
+        bool hasExpiresIn = false;
+        bool hasTimestamp = false;
+        const qint64 expiresIn = job->credentialsData().value(QStringLiteral("ExpiresIn")).toLongLong(&hasExpiresIn);
+        const qint64 issuedAt = job->credentialsData().value(QStringLiteral("Timestamp")).toLongLong(&hasTimestamp);
+        if (hasExpiresIn && expiresIn > 0 && hasTimestamp && issuedAt > 0) {
+            cloudAccount->expiresAt = QDateTime::fromSecsSinceEpoch(issuedAt + expiresIn, QTimeZone::UTC);
+        }
+    }
+
     qCDebug(ONEDRIVE) << "Got account credentials for:" << cloudAccount->accountName() << ", accessToken:" << elideToken(cloudAccount->accessToken())
-                      << ", refreshToken:" << elideToken(cloudAccount->refreshToken()) << ", scopes:" << cloudAccount->scopes;
+                      << ", refreshToken:" << elideToken(cloudAccount->refreshToken()) << ", scopes:" << cloudAccount->scopes
+                      << ", expires:" << cloudAccount->expiresAt;
 
     return cloudAccount;
 }
@@ -12,8 +12,12 @@
 #include "onedriveudsentry.h"
 #include "onedriveurl.h"
 #include "onedriveversion.h"
+#include "putdatadevice.h"
+#include "quickxorhash.h"
 
 #include <QApplication>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
 #include <QIODevice>
 #include <QMimeDatabase>
 #include <QNetworkReply>
@@ -25,6 +29,8 @@
 #include <KIO/Job>
 #include <KLocalizedString>
 
+#include <algorithm>
+
 namespace
 {
 KIO::WorkerResult sharedDrivesUnsupported(const QUrl &url)
@@ -37,6 +43,39 @@ KIO::WorkerResult personalContentUnsupported(const QString &action)
 {
     return KIO::WorkerResult::fail(KIO::ERR_UNSUPPORTED_ACTION, i18n("Only personal OneDrive content can be %1 for now.", action));
 }
+
+// Graph documents pre-authenticated download URLs as short-lived without giving a number, in
+// practice they last about an hour. Stay well below that.
+constexpr qint64 DownloadUrlTtlMs = 10 * 60 * 1000;
+
+// Access tokens last about an hour. Refresh a little ahead, so that an operation doesn't start with one that is about to lapse.
+constexpr qint64 TokenRefreshMarginSecs = 5 * 60;
+
+// KIO clients list a folder right after stat()ing it, children expanded by the stat() are only used that soon.
+constexpr qint64 ExpandedChildrenTtlMs = 10 * 1000;
+
+// Maps the "details" or "statDetails" metadata of a request to the driveItem fields worth fetching.
+// The web URL and the download URL that get() reuses have no detail of their own, they are left
+// out only when the client asked for nothing beyond basic details, times and mime types.
+OneDrive::ItemFields itemFieldsFor(const QString &detailsMetaData)
+{
+    if (detailsMetaData.isEmpty()) {
+        return OneDrive::ItemField::AllFields;
+    }
+
+    const auto details = KIO::StatDetails::fromInt(detailsMetaData.toInt());
+    OneDrive::ItemFields fields;
+    if (details.testFlag(KIO::StatTime)) {
+        fields |= OneDrive::ItemField::Times;
+    }
+    if (details.testFlag(KIO::StatUser)) {
+        fields |= OneDrive::ItemField::People;
+    }
+    if (details.testAnyFlags(~(KIO::StatBasic | KIO::StatTime | KIO::StatMimeType))) {
+        fields |= OneDrive::ItemField::Links;
+    }
+    return fields;
+}
 } // namespace
 
 class KIOPluginForMetaData : public QObject
@@ -64,16 +103,41 @@ int Q_DECL_EXPORT kdemain(int argc, char **argv)
 
 KIOOneDrive::KIOOneDrive(const QByteArray &protocol, const QByteArray &pool_socket, const QByteArray &app_socket)
     : WorkerBase("onedrive", pool_socket, app_socket)
+    , m_itemCache(DownloadUrlTtlMs)
 {
     Q_UNUSED(protocol);
 
     m_accountManager.reset(new AccountManager);
 
+    m_graphClient.setTokenRefresher([this](const QString &staleToken) {
+        const auto accountNames = m_accountManager->accounts();
+        for (const QString &accountName : accountNames) {
+            const auto account = m_accountManager->account(accountName);
+            if (account->accessToken() != staleToken) {
+                continue;
+            }
+            const auto refreshed = m_accountManager->refreshAccount(account);
+            return refreshed ? refreshed->accessToken() : QString();
+        }
+        return QString();
+    });
+
+    // Network setup happens on Qt's HTTP thread, so it goes on while we wait for the first command.
+    m_graphClient.warmUp();
+
     qCDebug(ONEDRIVE) << "KIO OneDrive ready: version" << ONEDRIVE_VERSION_STRING;
 }
 
 KIOOneDrive::~KIOOneDrive()
 {
+    const auto stats = m_graphClient.protocolStats();
+    qCDebug(ONEDRIVE) << "Replies over HTTP/1.1:" << stats.http1Replies << "over HTTP/2:" << stats.http2Replies
+                      << "HTTP/2 fallbacks:" << stats.http2Fallbacks << "first request:" << stats.firstRequestMs << "ms, TLS session ticket offered:"
+                      << stats.firstRequestOfferedTlsTicket << "stalled:" << stats.stalledReplies << "hedged:" << stats.hedgedRequests
+                      << "won by the hedge:" << stats.hedgesWon << "not modified:" << stats.notModifiedReplies;
+    const auto throttling = m_graphClient.throttlingStats();
+    qCDebug(ONEDRIVE) << "Throttled replies:" << throttling.throttledReplies << "retries:" << throttling.retries << "waited:" << throttling.retryDelayMs
+                      << "ms, gave up:" << throttling.exhaustedRetries << "paced:" << throttling.pacedRequests << "for" << throttling.pacingDelayMs << "ms";
     closeConnection();
 }
 
@@ -116,12 +180,38 @@ KIO::WorkerResult KIOOneDrive::fileSystemFreeSpace(const QUrl &url)
 
 OneDriveAccountPtr KIOOneDrive::getAccount(const QString &accountName)
 {
-    return m_accountManager->account(accountName);
+    // Every command that talks to Graph comes through here. EnableHttp2=true in kio_onedriverc opts in.
+    m_graphClient.setHttp2Enabled(configValue(QStringLiteral("EnableHttp2"), false));
+
+    auto account = m_accountManager->account(accountName);
+    if (!account->isValid() || !account->expiresWithin(TokenRefreshMarginSecs)) {
+        return account;
+    }
+
+    // The credentials service may keep handing out the cached token until it has actually expired,
+    // asking it again for every command would only block on D-Bus.
+    const QString previousToken = account->accessToken();
+    if (m_unrefreshedTokens.value(accountName) == previousToken && !account->expiresWithin(0)) {
+        return account;
+    }
+
+    qCDebug(ONEDRIVE) << "Access token of" << accountName << "expires at" << account->expiresAt << "- refreshing";
+    if (auto refreshed = m_accountManager->refreshAccount(account)) {
+        account = refreshed;
+    }
+    if (account->accessToken() == previousToken) {
+        qCDebug(ONEDRIVE) << "Refreshing" << accountName << "returned the same token, using it until it expires";
+        m_unrefreshedTokens.insert(accountName, previousToken);
+    } else {
+        m_unrefreshedTokens.remove(accountName);
+    }
+    return account;
 }
 
 KIO::WorkerResult KIOOneDrive::openConnection()
 {
     qCDebug(ONEDRIVE) << "Ready to talk to OneDrive";
+    m_graphClient.warmUp();
     return KIO::WorkerResult::pass();
 }
 
@@ -538,7 +628,7 @@ std::pair<KIO::WorkerResult, QString> KIOOneDrive::rootFolderId(const QString &a
     return {KIO::WorkerResult::pass(), *it};
 }
 
-KIO::UDSEntry KIOOneDrive::driveItemToEntry(const OneDrive::DriveItem &item) const
+KIO::UDSEntry KIOOneDrive::driveItemToEntry(const OneDrive::DriveItem &item, OneDrive::ItemFields fields) const
 {
     KIO::UDSEntry entry;
     entry.fastInsert(KIO::UDSEntry::UDS_NAME, item.name);
@@ -559,24 +649,28 @@ KIO::UDSEntry KIOOneDrive::driveItemToEntry(const OneDrive::DriveItem &item) con
         }
     }
 
-    if (item.lastModified.isValid()) {
-        entry.fastInsert(KIO::UDSEntry::UDS_MODIFICATION_TIME, item.lastModified.toSecsSinceEpoch());
-    }
-    if (item.createdTime.isValid()) {
-        entry.fastInsert(KIO::UDSEntry::UDS_CREATION_TIME, item.createdTime.toSecsSinceEpoch());
+    if (fields & OneDrive::ItemField::Times) {
+        if (item.lastModified.isValid()) {
+            entry.fastInsert(KIO::UDSEntry::UDS_MODIFICATION_TIME, item.lastModified.toSecsSinceEpoch());
+        }
+        if (item.createdTime.isValid()) {
+            entry.fastInsert(KIO::UDSEntry::UDS_CREATION_TIME, item.createdTime.toSecsSinceEpoch());
+        }
     }
 
     if (!item.id.isEmpty()) {
         entry.fastInsert(OneDriveUDSEntryExtras::Id, item.id);
     }
-    if (!item.webUrl.isEmpty()) {
+    if ((fields & OneDrive::ItemField::Links) && !item.webUrl.isEmpty()) {
         entry.fastInsert(OneDriveUDSEntryExtras::Url, item.webUrl);
     }
-    if (!item.lastModifiedBy.isEmpty()) {
-        entry.fastInsert(OneDriveUDSEntryExtras::LastModifyingUser, item.lastModifiedBy);
-    }
-    if (!item.createdBy.isEmpty()) {
-        entry.fastInsert(OneDriveUDSEntryExtras::Owners, item.createdBy);
+    if (fields & OneDrive::ItemField::People) {
+        if (!item.lastModifiedBy.isEmpty()) {
+            entry.fastInsert(OneDriveUDSEntryExtras::LastModifyingUser, item.lastModifiedBy);
+        }
+        if (!item.createdBy.isEmpty()) {
+            entry.fastInsert(OneDriveUDSEntryExtras::Owners, item.createdBy);
+        }
     }
 
     entry.fastInsert(KIO::UDSEntry::UDS_ACCESS, S_IRUSR | S_IWUSR | S_IXUSR | S_IRGRP | S_IWGRP | S_IXGRP | S_IROTH | S_IWOTH | S_IXOTH);
@@ -594,18 +688,123 @@ void KIOOneDrive::cacheSharedWithMeEntries(const QString &accountId, const QList
     }
 }
 
-KIO::WorkerResult KIOOneDrive::listAccountRoot(const QUrl &url, const QString &accountId, const OneDriveAccountPtr &account)
+KIO::WorkerResult
+KIOOneDrive::listAccountRoot(const QUrl &url, const QString &accountId, const OneDriveAccountPtr &account, OneDrive::ItemFields fields)
 {
     auto sharedWithMeEntry = sharedWithMeUDSEntry();
     listEntry(sharedWithMeEntry);
 
-    return listFolderByPath(url, accountId, account, QString());
+    return listFolderByPath(url, accountId, account, QString(), fields);
 }
 
-KIO::WorkerResult KIOOneDrive::listFolderByPath(const QUrl &url, const QString &accountId, const OneDriveAccountPtr &account, const QString &relativePath)
+bool KIOOneDrive::revalidateFolderModel(const QString &accountId, const OneDriveAccountPtr &account)
 {
-    const auto graphResult =
-        relativePath.isEmpty() ? m_graphClient.listChildren(account->accessToken()) : m_graphClient.listChildrenByPath(account->accessToken(), relativePath);
+    auto &model = m_folderModels[accountId];
+    if (model.deltaLink().isEmpty()) {
+        return false;
+    }
+
+    const auto delta = m_graphClient.fetchDelta(account->accessToken(), model.deltaLink());
+    if (!delta.success || delta.deltaLink.isEmpty()) {
+        // 410 Gone means Graph expired our token and wants a full resync, start over for any failure.
+        qCDebug(ONEDRIVE) << "Delta query failed for" << accountId << delta.httpStatus << delta.errorMessage << "- dropping folder model";
+        model.clear();
+        return false;
+    }
+
+    qCDebug(ONEDRIVE) << "Applying" << delta.items.size() << "delta changes for" << accountId;
+    // Paths resolved before may lead to another item now, or to none.
+    const QStringList relocatedIds = model.applyDelta(delta.items);
+    if (!relocatedIds.isEmpty()) {
+        for (const QString &path : m_cache.removeIds(relocatedIds)) {
+            m_itemCache.remove(path);
+        }
+    }
+    model.setDeltaLink(delta.deltaLink);
+    return true;
+}
+
+KIO::WorkerResult KIOOneDrive::listFolderByPath(const QUrl &url,
+                                                const QString &accountId,
+                                                const OneDriveAccountPtr &account,
+                                                const QString &relativePath,
+                                                OneDrive::ItemFields fields)
+{
+    const QString pathPrefix = url.path().endsWith(QLatin1Char('/')) ? url.path() : url.path() + QLatin1Char('/');
+    auto listItems = [&](const QList<OneDrive::DriveItem> &items) {
+        for (const auto &item : items) {
+            const KIO::UDSEntry entry = driveItemToEntry(item, fields);
+            listEntry(entry);
+            m_cache.insertPath(pathPrefix + item.name, item.id);
+        }
+    };
+    auto finishListing = [&]() {
+        KIO::UDSEntry dotEntry;
+        dotEntry.fastInsert(KIO::UDSEntry::UDS_NAME, QStringLiteral("."));
+        dotEntry.fastInsert(KIO::UDSEntry::UDS_FILE_TYPE, S_IFDIR);
+        dotEntry.fastInsert(KIO::UDSEntry::UDS_SIZE, 0);
+        dotEntry.fastInsert(KIO::UDSEntry::UDS_ACCESS, S_IRUSR | S_IWUSR | S_IXUSR | S_IRGRP | S_IWGRP | S_IXGRP | S_IROTH | S_IWOTH | S_IXOTH);
+        listEntry(dotEntry);
+    };
+
+    // Folders we listed before only need the changes since then.
+    auto &model = m_folderModels[accountId];
+    const QString folderId = relativePath.isEmpty() ? m_rootIds.value(accountId) : m_cache.idForPath(url.adjusted(QUrl::StripTrailingSlash).path());
+    if (!folderId.isEmpty() && model.hasFolder(folderId) && revalidateFolderModel(accountId, account) && model.hasFolder(folderId)) {
+        listItems(model.children(folderId));
+        finishListing();
+        return KIO::WorkerResult::pass();
+    }
+
+    // Get a delta link before listing, so that changes racing with the listing are replayed next time.
+    if (model.deltaLink().isEmpty()) {
+        if (const auto latest = m_graphClient.fetchDelta(account->accessToken()); latest.success) {
+            model.setDeltaLink(latest.deltaLink);
+        }
+    }
+
+    // stat() may have brought the first page of children along already.
+    std::optional<ExpandedFolder> expanded = std::exchange(m_expandedFolder, std::nullopt);
+    if (expanded && (expanded->path != url.adjusted(QUrl::StripTrailingSlash).path() || expanded->expiry.hasExpired())) {
+        expanded.reset();
+    }
+
+    // Entries go out as each page lands, only the folder model needs the complete listing.
+    // The model answers later listings whatever they ask for, so it only takes items with every field.
+    QList<OneDrive::DriveItem> listedItems;
+    QString listedFolderId = folderId;
+    const bool allFields = expanded || fields == OneDrive::ItemField::AllFields;
+    const bool keepItems = allFields && !model.deltaLink().isEmpty() && (!expanded || expanded->deltaLinkKnown);
+    auto onPage = [&](const QList<OneDrive::DriveItem> &items) {
+        listItems(items);
+        if (allFields || (fields & OneDrive::ItemField::Links)) {
+            for (const auto &item : items) {
+                m_itemCache.insert(pathPrefix + item.name, item);
+            }
+        }
+        // The children tell us the folder ID, even when nothing was cached for this path yet.
+        if (!items.isEmpty()) {
+            listedFolderId = items.constFirst().parentId;
+        }
+        if (keepItems) {
+            listedItems.append(items);
+        }
+        return !wasKilled();
+    };
+
+    OneDrive::ListChildrenResult graphResult;
+    if (expanded) {
+        qCDebug(ONEDRIVE) << "Listing" << url.path() << "starting with the children fetched by stat()";
+        graphResult.success = onPage(expanded->children);
+        if (graphResult.success && !expanded->nextLink.isEmpty()) {
+            graphResult = m_graphClient.continueListing(account->accessToken(), expanded->nextLink, onPage);
+        }
+    } else {
+        graphResult = m_graphClient.listChildrenByPath(account->accessToken(), relativePath, onPage, fields);
+    }
+    if (wasKilled()) {
+        return KIO::WorkerResult::pass();
+    }
     if (!graphResult.success) {
         qCWarning(ONEDRIVE) << "Graph listChildren failed for" << accountId << relativePath << graphResult.httpStatus << graphResult.errorMessage;
         if (graphResult.httpStatus == 401 || graphResult.httpStatus == 403) {
@@ -614,19 +813,14 @@ KIO::WorkerResult KIOOneDrive::listFolderByPath(const QUrl &url, const QString &
         return KIO::WorkerResult::fail(KIO::ERR_WORKER_DEFINED, i18n("Failed to list OneDrive files for %1: %2", accountId, graphResult.errorMessage));
     }
 
-    const QString pathPrefix = url.path().endsWith(QLatin1Char('/')) ? url.path() : url.path() + QLatin1Char('/');
-    for (const auto &item : graphResult.items) {
-        const KIO::UDSEntry entry = driveItemToEntry(item);
-        listEntry(entry);
-        m_cache.insertPath(pathPrefix + item.name, item.id);
-    }
+    finishListing();
 
-    KIO::UDSEntry dotEntry;
-    dotEntry.fastInsert(KIO::UDSEntry::UDS_NAME, QStringLiteral("."));
-    dotEntry.fastInsert(KIO::UDSEntry::UDS_FILE_TYPE, S_IFDIR);
-    dotEntry.fastInsert(KIO::UDSEntry::UDS_SIZE, 0);
-    dotEntry.fastInsert(KIO::UDSEntry::UDS_ACCESS, S_IRUSR | S_IWUSR | S_IXUSR | S_IRGRP | S_IWGRP | S_IXGRP | S_IROTH | S_IWOTH | S_IXOTH);
-    listEntry(dotEntry);
+    if (relativePath.isEmpty() && !listedFolderId.isEmpty() && !m_rootIds.contains(accountId)) {
+        m_rootIds.insert(accountId, listedFolderId);
+    }
+    if (keepItems && !listedFolderId.isEmpty()) {
+        model.setChildren(listedFolderId, listedItems);
+    }
 
     return KIO::WorkerResult::pass();
 }
@@ -654,8 +848,9 @@ KIO::WorkerResult KIOOneDrive::listDir(const QUrl &url)
         return KIO::WorkerResult::fail(KIO::ERR_WORKER_DEFINED, i18n("%1 isn't a known OneDrive account", accountId));
     }
 
+    const OneDrive::ItemFields fields = itemFieldsFor(metaData(QStringLiteral("details")));
     if (oneDriveUrl.isAccountRoot()) {
-        return listAccountRoot(url, accountId, account);
+        return listAccountRoot(url, accountId, account, fields);
     }
 
     if (oneDriveUrl.isSharedDrivesRoot() || oneDriveUrl.isSharedDrive()) {
@@ -675,7 +870,7 @@ KIO::WorkerResult KIOOneDrive::listDir(const QUrl &url)
         cacheSharedWithMeEntries(accountId, sharedItems.items);
         const QString pathPrefix = url.path().mid(1) + (url.path().endsWith(QLatin1Char('/')) ? QString() : QStringLiteral("/"));
         for (const auto &item : sharedItems.items) {
-            const KIO::UDSEntry entry = driveItemToEntry(item);
+            const KIO::UDSEntry entry = driveItemToEntry(item, fields);
             listEntry(entry);
         }
 
@@ -698,7 +893,23 @@ KIO::WorkerResult KIOOneDrive::listDir(const QUrl &url)
             return KIO::WorkerResult::fail(KIO::ERR_DOES_NOT_EXIST, url.path());
         }
 
-        const auto graphResult = m_graphClient.listChildren(account->accessToken(), ids.at(0), ids.at(1));
+        const QString pathPrefix = url.path().endsWith(QLatin1Char('/')) ? url.path() : url.path() + QLatin1Char('/');
+        auto onPage = [&](const QList<OneDrive::DriveItem> &items) {
+            for (const auto &item : items) {
+                const KIO::UDSEntry entry = driveItemToEntry(item, fields);
+                listEntry(entry);
+                m_cache.insertPath(pathPrefix + item.name, QStringLiteral("%1|%2").arg(item.driveId, item.id));
+                if (fields & OneDrive::ItemField::Links) {
+                    m_itemCache.insert(pathPrefix + item.name, item);
+                }
+            }
+            return !wasKilled();
+        };
+
+        const auto graphResult = m_graphClient.listChildren(account->accessToken(), ids.at(0), ids.at(1), onPage, fields);
+        if (wasKilled()) {
+            return KIO::WorkerResult::pass();
+        }
         if (!graphResult.success) {
             if (graphResult.httpStatus == 401 || graphResult.httpStatus == 403) {
                 return KIO::WorkerResult::fail(KIO::ERR_CANNOT_LOGIN, url.toDisplayString());
@@ -709,13 +920,6 @@ KIO::WorkerResult KIOOneDrive::listDir(const QUrl &url)
             return KIO::WorkerResult::fail(KIO::ERR_WORKER_DEFINED, graphResult.errorMessage);
         }
 
-        const QString pathPrefix = url.path().endsWith(QLatin1Char('/')) ? url.path() : url.path() + QLatin1Char('/');
-        for (const auto &item : graphResult.items) {
-            const KIO::UDSEntry entry = driveItemToEntry(item);
-            listEntry(entry);
-            m_cache.insertPath(pathPrefix + item.name, QStringLiteral("%1|%2").arg(item.driveId, item.id));
-        }
-
         KIO::UDSEntry dotEntry;
         dotEntry.fastInsert(KIO::UDSEntry::UDS_NAME, QStringLiteral("."));
         dotEntry.fastInsert(KIO::UDSEntry::UDS_FILE_TYPE, S_IFDIR);
@@ -729,14 +933,16 @@ KIO::WorkerResult KIOOneDrive::listDir(const QUrl &url)
         && !oneDriveUrl.isTrashDir() && !oneDriveUrl.isTrashed()) {
         const auto components = oneDriveUrl.pathComponents();
         const QString relativePath = components.mid(1).join(QStringLiteral("/"));
-        return listFolderByPath(url, accountId, account, relativePath);
+        return listFolderByPath(url, accountId, account, relativePath, fields);
     }
 
-    return listFolderByPath(url, accountId, account, oneDriveUrl.pathComponents().mid(1).join(QStringLiteral("/")));
+    return listFolderByPath(url, accountId, account, oneDriveUrl.pathComponents().mid(1).join(QStringLiteral("/")), fields);
 }
 
 KIO::WorkerResult KIOOneDrive::mkdir(const QUrl &url, int permissions)
 {
+    m_expandedFolder.reset();
+
     // NOTE: We deliberately ignore the permissions field here, because OneDrive
     // does not recognize any privileges that could be mapped to standard UNIX
     // file permissions.
@@ -824,10 +1030,8 @@ KIO::WorkerResult KIOOneDrive::mkdir(const QUrl &url, int permissions)
 
 KIO::WorkerResult KIOOneDrive::stat(const QUrl &url)
 {
-    // TODO We should be using StatDetails to limit how we respond to a stat request
-    // const QString statDetails = metaData(QStringLiteral("statDetails"));
-    // KIO::StatDetails details = statDetails.isEmpty() ? KIO::StatDefaultDetails : static_cast<KIO::StatDetails>(statDetails.toInt());
-    // qCDebug(ONEDRIVE) << "Going to stat()" << url << "for details" << details;
+    const OneDrive::ItemFields fields = itemFieldsFor(metaData(QStringLiteral("statDetails")));
+    qCDebug(ONEDRIVE) << "Going to stat()" << url << "for fields" << fields;
 
     const auto oneDriveUrl = OneDriveUrl(url);
     if (oneDriveUrl.isRoot()) {
@@ -875,7 +1079,7 @@ KIO::WorkerResult KIOOneDrive::stat(const QUrl &url)
             return KIO::WorkerResult::fail(KIO::ERR_WORKER_DEFINED, graphItem.errorMessage);
         }
 
-        const KIO::UDSEntry entry = driveItemToEntry(graphItem.item);
+        const KIO::UDSEntry entry = driveItemToEntry(graphItem.item, fields);
         statEntry(entry);
         return KIO::WorkerResult::pass();
     }
@@ -908,7 +1112,13 @@ KIO::WorkerResult KIOOneDrive::stat(const QUrl &url)
     if (!oneDriveUrl.isSharedWithMe() && !oneDriveUrl.isSharedWithMeRoot() && !oneDriveUrl.isSharedDrivesRoot() && !oneDriveUrl.isSharedDrive()
         && !oneDriveUrl.isTrashDir() && !oneDriveUrl.isTrashed()) {
         const QString relativePath = oneDriveUrl.pathComponents().mid(1).join(QStringLiteral("/"));
-        const auto graphItem = m_graphClient.getItemByPath(account->accessToken(), relativePath);
+        // Only a stat() for every detail is likely to be followed by a listing, existence and type
+        // checks ask for less and get the plain, revalidated item. Folders the model already holds
+        // are listed from it, there is no point in fetching their children.
+        const auto &model = m_folderModels[accountId];
+        const QString cachedId = m_cache.idForPath(url.path());
+        const bool expandChildren = fields == OneDrive::ItemField::AllFields && (cachedId.isEmpty() || !model.hasFolder(cachedId));
+        const auto graphItem = m_graphClient.getItemByPath(account->accessToken(), relativePath, expandChildren, fields);
         if (!graphItem.success) {
             qCWarning(ONEDRIVE) << "Graph getItemByPath failed for" << accountId << relativePath << graphItem.httpStatus << graphItem.errorMessage;
             if (graphItem.httpStatus == 401 || graphItem.httpStatus == 403) {
@@ -920,9 +1130,19 @@ KIO::WorkerResult KIOOneDrive::stat(const QUrl &url)
             return KIO::WorkerResult::fail(KIO::ERR_WORKER_DEFINED, graphItem.errorMessage);
         }
 
-        const KIO::UDSEntry entry = driveItemToEntry(graphItem.item);
+        const KIO::UDSEntry entry = driveItemToEntry(graphItem.item, fields);
         statEntry(entry);
         m_cache.insertPath(url.path(), graphItem.item.id);
+        if (fields & OneDrive::ItemField::Links) {
+            m_itemCache.insert(url.path(), graphItem.item);
+        }
+        if (graphItem.item.isFolder && graphItem.childrenExpanded) {
+            m_expandedFolder = ExpandedFolder{url.adjusted(QUrl::StripTrailingSlash).path(),
+                                              graphItem.children,
+                                              graphItem.childrenNextLink,
+                                              !model.deltaLink().isEmpty(),
+                                              QDeadlineTimer(ExpandedChildrenTtlMs)};
+        }
         return KIO::WorkerResult::pass();
     }
 
@@ -947,8 +1167,9 @@ KIO::WorkerResult KIOOneDrive::stat(const QUrl &url)
             return KIO::WorkerResult::fail(KIO::ERR_WORKER_DEFINED, graphItem.errorMessage);
         }
 
-        const KIO::UDSEntry entry = driveItemToEntry(graphItem.item);
+        const KIO::UDSEntry entry = driveItemToEntry(graphItem.item, fields);
         statEntry(entry);
+        m_itemCache.insert(url.path(), graphItem.item);
         return KIO::WorkerResult::pass();
     }
 
@@ -957,6 +1178,9 @@ KIO::WorkerResult KIOOneDrive::stat(const QUrl &url)
 
 namespace
 {
+// Each processedSize() is a message to the application; per chunk is far more often than a progress bar needs.
+constexpr qint64 ProgressReportIntervalMs = 250;
+
 struct StreamResult {
     bool success = false;
     int httpStatus = 0;
@@ -977,18 +1201,31 @@ StreamResult streamItemToClient(KIO::WorkerBase *worker,
         if (item.size > 0) {
             worker->totalSize(item.size);
         }
-        const auto streamResult = graphClient.streamDownloadItem(token, item.id, item.downloadUrl, item.driveId, [&](const QByteArray &chunk) {
+        QElapsedTimer sinceProgress;
+        sinceProgress.start();
+        OneDrive::QuickXorHash hash;
+        const auto streamResult = graphClient.streamDownloadItem(token, item.id, item.downloadUrl, item.driveId, item.size, [&](const QByteArray &chunk) {
             if (chunk.isEmpty()) {
                 return true;
             }
-            worker->processedSize(transferred + chunk.size());
             worker->data(chunk);
+            hash.addData(chunk);
             transferred += chunk.size();
+            if (sinceProgress.hasExpired(ProgressReportIntervalMs)) {
+                worker->processedSize(transferred);
+                sinceProgress.restart();
+            }
             return true;
         });
         result.success = streamResult.success;
         result.httpStatus = streamResult.httpStatus;
         result.errorMessage = streamResult.errorMessage;
+        if (streamResult.success && !item.quickXorHash.isEmpty() && !hash.matches(item.quickXorHash)) {
+            qCWarning(ONEDRIVE) << "Downloaded data of" << item.id << "has QuickXorHash" << hash.result().toBase64() << "instead of" << item.quickXorHash;
+            result.success = false;
+            result.errorMessage = i18n("The downloaded data of %1 doesn't match its checksum.", item.name);
+            return result;
+        }
         if (streamResult.success) {
             if (item.size <= 0) {
                 worker->totalSize(transferred);
@@ -999,7 +1236,7 @@ StreamResult streamItemToClient(KIO::WorkerBase *worker,
         return result;
     };
 
-    // TODO: factor this retry logic somewhere common
+    // Downloads stream outside of Client's request executor, so its 401 retry doesn't cover them.
     auto result = streamItem(currentAccount->accessToken());
     if (!result.success && (result.httpStatus == 401 || result.httpStatus == 403)) {
         currentAccount = refreshAccount(currentAccount);
@@ -1014,6 +1251,17 @@ StreamResult streamItemToClient(KIO::WorkerBase *worker,
 std::pair<KIO::WorkerResult, OneDrive::DriveItem>
 KIOOneDrive::resolveItemForGet(const QUrl &url, const OneDriveUrl &oneDriveUrl, const QString &accountId, const OneDriveAccountPtr &account)
 {
+    // A recent listing or stat already gave us a download URL. Should it have gone stale after
+    // all, the download falls back to the Graph content endpoint.
+    // The file may have changed since, so its cached hash isn't checked. Ranged downloads are planned
+    // from the size, big files are worth a revalidated lookup instead.
+    if (auto cached = m_itemCache.item(url.path()); cached && cached->size < OneDrive::Client::RangedDownloadThreshold) {
+        qCDebug(ONEDRIVE) << "Using cached download URL for" << url.path();
+        cached->quickXorHash.clear();
+        cached->sha1Hash.clear();
+        return {KIO::WorkerResult::pass(), *cached};
+    }
+
     if (oneDriveUrl.isSharedWithMe()) {
         const auto [keyResult, remoteKey] = resolveSharedWithMeKey(url, accountId, account);
         if (!keyResult.success()) {
@@ -1037,6 +1285,7 @@ KIOOneDrive::resolveItemForGet(const QUrl &url, const OneDriveUrl &oneDriveUrl,
             return {KIO::WorkerResult::fail(KIO::ERR_WORKER_DEFINED, graphItem.errorMessage), OneDrive::DriveItem()};
         }
 
+        m_itemCache.insert(url.path(), graphItem.item);
         return {KIO::WorkerResult::pass(), graphItem.item};
     }
 
@@ -1053,6 +1302,7 @@ KIOOneDrive::resolveItemForGet(const QUrl &url, const OneDriveUrl &oneDriveUrl,
         return {KIO::WorkerResult::fail(KIO::ERR_WORKER_DEFINED, graphItem.errorMessage), OneDrive::DriveItem()};
     }
 
+    m_itemCache.insert(url.path(), graphItem.item);
     return {KIO::WorkerResult::pass(), graphItem.item};
 }
 
@@ -1113,28 +1363,34 @@ KIO::WorkerResult KIOOneDrive::get(const QUrl &url)
     return KIO::WorkerResult::fail(KIO::ERR_CANNOT_READ, downloadResult.errorMessage);
 }
 
-KIO::WorkerResult KIOOneDrive::readPutData(QTemporaryFile &tempFile, const QString &fileName, QString *detectedMimeType)
+KIO::WorkerResult KIOOneDrive::readPutData(QTemporaryFile &tempFile, const QString &fileName, QString *detectedMimeType, OneDrive::QuickXorHash *hash)
 {
     if (!tempFile.open()) {
         return KIO::WorkerResult::fail(KIO::ERR_CANNOT_WRITE, tempFile.fileName());
     }
 
+    QByteArray firstBlock;
     int result;
     do {
         QByteArray buffer;
         dataReq();
         result = readData(buffer);
         if (!buffer.isEmpty()) {
+            if (firstBlock.isEmpty()) {
+                firstBlock = buffer;
+            }
             qint64 size = tempFile.write(buffer);
             if (size != buffer.size()) {
                 return KIO::WorkerResult::fail(KIO::ERR_CANNOT_WRITE, tempFile.fileName());
             }
+            if (hash) {
+                hash->addData(buffer);
+            }
         }
     } while (result > 0);
 
-    const QMimeType mime = QMimeDatabase().mimeTypeForFileNameAndData(fileName, &tempFile);
     if (detectedMimeType) {
-        *detectedMimeType = mime.name();
+        *detectedMimeType = QMimeDatabase().mimeTypeForFileNameAndData(fileName, firstBlock).name();
     }
 
     if (!tempFile.seek(0)) {
@@ -1149,6 +1405,82 @@ KIO::WorkerResult KIOOneDrive::readPutData(QTemporaryFile &tempFile, const QStri
     return KIO::WorkerResult::pass();
 }
 
+std::pair<KIO::WorkerResult, OneDrive::UploadResult>
+KIOOneDrive::uploadPutData(const QString &fileName, const PutUploadFunc &upload, const OneDrive::DriveItem &replacedItem)
+{
+    // The data is hashed as it comes from the application. Graph doesn't always have the hash of a
+    // fresh upload ready in its reply, there is nothing to compare against then.
+    auto verify = [&fileName](const OneDrive::QuickXorHash &hash, const OneDrive::UploadResult &uploadResult) {
+        if (!uploadResult.success || uploadResult.item.quickXorHash.isEmpty() || hash.matches(uploadResult.item.quickXorHash)) {
+            return KIO::WorkerResult::pass();
+        }
+        qCWarning(ONEDRIVE) << "Uploaded" << uploadResult.item.id << "has QuickXorHash" << uploadResult.item.quickXorHash << "instead of"
+                            << hash.result().toBase64();
+        return KIO::WorkerResult::fail(KIO::ERR_CANNOT_WRITE, i18n("The uploaded data of %1 doesn't match its checksum.", fileName));
+    };
+
+    // KIO announces the source size for file copies, which is all an upload session needs to start
+    // sending before the data is complete. Without it we have to stage the data locally first.
+    bool sizeKnown = false;
+    const qint64 expectedSize = metaData(QStringLiteral("size")).toLongLong(&sizeKnown);
+    // Data that may well be what is already stored has to be complete before we can tell, so it is staged.
+    const bool hasReplacedHash = !replacedItem.quickXorHash.isEmpty() || !replacedItem.sha1Hash.isEmpty();
+    const bool mayBeUnchanged = hasReplacedHash && (!sizeKnown || expectedSize == replacedItem.size);
+    if (sizeKnown && expectedSize > 0 && !mayBeUnchanged) {
+        PutDataDevice source(this, expectedSize);
+        source.open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+
+        const QByteArray firstBlock = source.firstBlock();
+        if (source.failed()) {
+            return {KIO::WorkerResult::fail(KIO::ERR_CANNOT_READ, QString()), OneDrive::UploadResult()};
+        }
+        const QString mimeType = QMimeDatabase().mimeTypeForFileNameAndData(fileName, firstBlock).name();
+
+        totalSize(expectedSize);
+        auto uploadResult = upload(&source, mimeType);
+        if (source.failed()) {
+            return {KIO::WorkerResult::fail(KIO::ERR_CANNOT_READ, QString()), OneDrive::UploadResult()};
+        }
+        return {verify(source.quickXorHash(), uploadResult), uploadResult};
+    }
+
+    QTemporaryFile tmpFile;
+    QString mimeType;
+    OneDrive::QuickXorHash hash;
+    if (auto result = readPutData(tmpFile, fileName, &mimeType, &hash); !result.success()) {
+        return {result, OneDrive::UploadResult()};
+    }
+    totalSize(tmpFile.size());
+
+    if (hasReplacedHash && tmpFile.size() == replacedItem.size) {
+        bool unchanged = false;
+        if (!replacedItem.quickXorHash.isEmpty()) {
+            unchanged = hash.matches(replacedItem.quickXorHash);
+        } else {
+            // Only older personal drive items come with just a SHA-1.
+            QCryptographicHash sha1(QCryptographicHash::Sha1);
+            unchanged = sha1.addData(&tmpFile) && tmpFile.seek(0)
+                && sha1.result().toHex().compare(replacedItem.sha1Hash.toLatin1(), Qt::CaseInsensitive) == 0;
+        }
+        if (unchanged) {
+            qCDebug(ONEDRIVE) << "Data for" << fileName << "matches item" << replacedItem.id << "- skipping the upload";
+            processedSize(tmpFile.size());
+            OneDrive::UploadResult unchangedResult;
+            unchangedResult.success = true;
+            unchangedResult.httpStatus = 200;
+            unchangedResult.item = replacedItem;
+            return {KIO::WorkerResult::pass(), unchangedResult};
+        }
+        if (!tmpFile.seek(0)) {
+            return {KIO::WorkerResult::fail(KIO::ERR_CANNOT_READ, tmpFile.fileName()), OneDrive::UploadResult()};
+        }
+    }
+
+    auto uploadResult = upload(&tmpFile, mimeType);
+    tmpFile.close();
+    return {verify(hash, uploadResult), uploadResult};
+}
+
 KIO::WorkerResult KIOOneDrive::putUpdate(const QUrl &url)
 {
     const QString fileId = QUrlQuery(url).queryItemValue(QStringLiteral("id"));
@@ -1175,13 +1507,24 @@ KIO::WorkerResult KIOOneDrive::putUpdate(const QUrl &url)
         return KIO::WorkerResult::fail(KIO::ERR_WORKER_DEFINED, i18n("%1 isn't a known OneDrive account", accountId));
     }
 
-    QTemporaryFile tmpFile;
-    QString mimeType;
-    if (auto result = readPutData(tmpFile, oneDriveUrl.filename(), &mimeType); !result.success()) {
-        return result;
+    // Editors save unchanged documents all the time. The lookup is revalidated with the eTag, unlike
+    // a cached item it can't hold an outdated hash that would make us skip a real change.
+    const auto currentItem = m_graphClient.getItemById(account->accessToken(), QString(), fileId);
+    if (!currentItem.success) {
+        qCDebug(ONEDRIVE) << "Could not look up" << fileId << "before replacing it:" << currentItem.httpStatus << currentItem.errorMessage;
+    }
+
+    const auto [readResult, uploadResult] = uploadPutData(
+        oneDriveUrl.filename(),
+        [&](QIODevice *source, const QString &mimeType) {
+            return m_graphClient.uploadItemById(account->accessToken(), QString(), fileId, source, mimeType, [this](qint64 uploaded) {
+                processedSize(uploaded);
+            });
+        },
+        currentItem.success ? currentItem.item : OneDrive::DriveItem());
+    if (!readResult.success()) {
+        return readResult;
     }
-    const auto uploadResult = m_graphClient.uploadItemById(account->accessToken(), QString(), fileId, &tmpFile, mimeType);
-    tmpFile.close();
     if (!uploadResult.success) {
         if (uploadResult.httpStatus == 401 || uploadResult.httpStatus == 403) {
             return KIO::WorkerResult::fail(KIO::ERR_CANNOT_LOGIN, url.toDisplayString());
@@ -1193,6 +1536,12 @@ KIO::WorkerResult KIOOneDrive::putUpdate(const QUrl &url)
     }
 
     const QString normalizedPath = url.adjusted(QUrl::StripTrailingSlash).path();
+    if (!uploadResult.item.eTag.isEmpty() && uploadResult.item.eTag == currentItem.item.eTag) {
+        // Nothing was uploaded, the item we looked up is still current.
+        m_itemCache.insert(normalizedPath, uploadResult.item);
+    } else {
+        m_itemCache.remove(normalizedPath);
+    }
     if (!normalizedPath.isEmpty()) {
         const QString cachedId = uploadResult.item.id.isEmpty() ? fileId : uploadResult.item.id;
         m_cache.insertPath(normalizedPath, cachedId);
@@ -1250,13 +1599,14 @@ KIO::WorkerResult KIOOneDrive::putCreate(const QUrl &url)
         }
     }
 
-    QTemporaryFile tmpFile;
-    QString mimeType;
-    if (auto result = readPutData(tmpFile, oneDriveUrl.filename(), &mimeType); !result.success()) {
-        return result;
+    const auto [readResult, uploadResult] = uploadPutData(oneDriveUrl.filename(), [&](QIODevice *source, const QString &mimeType) {
+        return m_graphClient.uploadItemByPath(account->accessToken(), relativePath, source, mimeType, [this](qint64 uploaded) {
+            processedSize(uploaded);
+        });
+    });
+    if (!readResult.success()) {
+        return readResult;
     }
-    const auto uploadResult = m_graphClient.uploadItemByPath(account->accessToken(), relativePath, &tmpFile, mimeType);
-    tmpFile.close();
     if (!uploadResult.success) {
         if (uploadResult.httpStatus == 401 || uploadResult.httpStatus == 403) {
             return KIO::WorkerResult::fail(KIO::ERR_CANNOT_LOGIN, url.toDisplayString());
@@ -1268,6 +1618,7 @@ KIO::WorkerResult KIOOneDrive::putCreate(const QUrl &url)
     }
 
     const QString normalizedPath = url.adjusted(QUrl::StripTrailingSlash).path();
+    m_itemCache.remove(normalizedPath);
     if (!normalizedPath.isEmpty() && !uploadResult.item.id.isEmpty()) {
         m_cache.insertPath(normalizedPath, uploadResult.item.id);
     }
@@ -1277,6 +1628,8 @@ KIO::WorkerResult KIOOneDrive::putCreate(const QUrl &url)
 
 KIO::WorkerResult KIOOneDrive::put(const QUrl &url, int permissions, KIO::JobFlags flags)
 {
+    m_expandedFolder.reset();
+
     // NOTE: We deliberately ignore the permissions field here, because OneDrive
     // does not recognize any privileges that could be mapped to standard UNIX
     // file permissions.
@@ -1316,6 +1669,8 @@ KIO::WorkerResult KIOOneDrive::put(const QUrl &url, int permissions, KIO::JobFla
 
 KIO::WorkerResult KIOOneDrive::copy(const QUrl &src, const QUrl &dest, int permissions, KIO::JobFlags flags)
 {
+    m_expandedFolder.reset();
+
     qCDebug(ONEDRIVE) << "Going to copy" << src << "to" << dest;
 
     // NOTE: We deliberately ignore the permissions field here, because OneDrive
@@ -1366,16 +1721,6 @@ KIO::WorkerResult KIOOneDrive::copy(const QUrl &src, const QUrl &dest, int permi
         return KIO::WorkerResult::fail(KIO::ERR_DOES_NOT_EXIST, src.path());
     }
     const QString srcRelativePath = srcComponents.mid(1).join(QStringLiteral("/"));
-    const auto sourceItem = m_graphClient.getItemByPath(account->accessToken(), srcRelativePath);
-    if (!sourceItem.success) {
-        if (sourceItem.httpStatus == 401 || sourceItem.httpStatus == 403) {
-            return KIO::WorkerResult::fail(KIO::ERR_CANNOT_LOGIN, src.toDisplayString());
-        }
-        if (sourceItem.httpStatus == 404) {
-            return KIO::WorkerResult::fail(KIO::ERR_DOES_NOT_EXIST, src.path());
-        }
-        return KIO::WorkerResult::fail(KIO::ERR_WORKER_DEFINED, sourceItem.errorMessage);
-    }
 
     if (destOneDriveUrl.isRoot()) {
         return KIO::WorkerResult::fail(KIO::ERR_ACCESS_DENIED, dest.path());
@@ -1394,7 +1739,23 @@ KIO::WorkerResult KIOOneDrive::copy(const QUrl &src, const QUrl &dest, int permi
         return components.mid(1, components.size() - 2).join(QStringLiteral("/"));
     };
     const QString destParentPath = relativeParentPath(destComponents);
-    const auto destParentItem = m_graphClient.getItemByPath(account->accessToken(), destParentPath);
+
+    // The source item and the destination parent don't depend on each other, look them up concurrently.
+    const auto sourceFuture = m_graphClient.getItemByPathAsync(account->accessToken(), srcRelativePath);
+    const auto destParentFuture = m_graphClient.getItemByPathAsync(account->accessToken(), destParentPath);
+
+    const auto sourceItem = OneDrive::Client::waitFor(sourceFuture);
+    if (!sourceItem.success) {
+        if (sourceItem.httpStatus == 401 || sourceItem.httpStatus == 403) {
+            return KIO::WorkerResult::fail(KIO::ERR_CANNOT_LOGIN, src.toDisplayString());
+        }
+        if (sourceItem.httpStatus == 404) {
+            return KIO::WorkerResult::fail(KIO::ERR_DOES_NOT_EXIST, src.path());
+        }
+        return KIO::WorkerResult::fail(KIO::ERR_WORKER_DEFINED, sourceItem.errorMessage);
+    }
+
+    const auto destParentItem = OneDrive::Client::waitFor(destParentFuture);
     if (!destParentItem.success) {
         if (destParentItem.httpStatus == 401 || destParentItem.httpStatus == 403) {
             return KIO::WorkerResult::fail(KIO::ERR_CANNOT_LOGIN, dest.toDisplayString());
@@ -1417,7 +1778,19 @@ KIO::WorkerResult KIOOneDrive::copy(const QUrl &src, const QUrl &dest, int permi
     }
 
     const QString destRelativePath = destComponents.mid(1).join(QStringLiteral("/"));
-    const auto copyResult = m_graphClient.copyItem(account->accessToken(), QString(), sourceItem.item.id, destName, parentGraphPath, destRelativePath);
+    const qint64 copySize = sourceItem.item.size;
+    if (copySize > 0) {
+        totalSize(copySize);
+    }
+    auto onProgress = [this, copySize](double percentageComplete) {
+        if (copySize > 0) {
+            processedSize(static_cast<KIO::filesize_t>(copySize * std::clamp(percentageComplete, 0.0, 100.0) / 100));
+        } else {
+            infoMessage(i18nc("@info:status", "Copying… %1%", qRound(percentageComplete)));
+        }
+    };
+    const auto copyResult =
+        m_graphClient.copyItem(account->accessToken(), QString(), sourceItem.item.id, destName, parentGraphPath, destRelativePath, onProgress);
     const QString copiedItemId = copyResult.item.id;
     if (!copyResult.success) {
         qCWarning(ONEDRIVE) << "Graph copyItem failed for" << src << "->" << dest << copyResult.httpStatus << copyResult.errorMessage;
@@ -1434,15 +1807,21 @@ KIO::WorkerResult KIOOneDrive::copy(const QUrl &src, const QUrl &dest, int permi
     }
 
     const QString normalizedDestPath = dest.adjusted(QUrl::StripTrailingSlash).path();
+    m_itemCache.remove(normalizedDestPath);
     if (!normalizedDestPath.isEmpty() && !copiedItemId.isEmpty()) {
         m_cache.insertPath(normalizedDestPath, copiedItemId);
     }
+    if (copySize > 0) {
+        processedSize(copySize);
+    }
 
     return KIO::WorkerResult::pass();
 }
 
 KIO::WorkerResult KIOOneDrive::del(const QUrl &url, bool isfile)
 {
+    m_expandedFolder.reset();
+
     Q_UNUSED(isfile)
     const auto oneDriveUrl = OneDriveUrl(url);
 
@@ -1508,11 +1887,14 @@ KIO::WorkerResult KIOOneDrive::del(const QUrl &url, bool isfile)
     }
 
     m_cache.removePath(url.path());
+    m_itemCache.remove(url.path());
     return KIO::WorkerResult::pass();
 }
 
 KIO::WorkerResult KIOOneDrive::rename(const QUrl &src, const QUrl &dest, KIO::JobFlags flags)
 {
+    m_expandedFolder.reset();
+
     Q_UNUSED(flags)
     qCDebug(ONEDRIVE) << "Renaming" << src << "to" << dest;
 
@@ -1618,6 +2000,8 @@ KIO::WorkerResult KIOOneDrive::rename(const QUrl &src, const QUrl &dest, KIO::Jo
         m_cache.removePath(normalizedSrcPath);
     }
     const QString normalizedDestPath = dest.adjusted(QUrl::StripTrailingSlash).path();
+    m_itemCache.remove(normalizedSrcPath);
+    m_itemCache.remove(normalizedDestPath);
     if (!normalizedDestPath.isEmpty()) {
         const QString updatedId = updateResult.item.id.isEmpty() ? graphItem.item.id : updateResult.item.id;
         m_cache.insertPath(normalizedDestPath, updatedId);
@@ -9,6 +9,8 @@
 #ifndef KIO_ONEDRIVE_H
 #define KIO_ONEDRIVE_H
 
+#include "foldermodel.h"
+#include "itemcache.h"
 #include "onedriveaccount.h"
 #include "onedriveclient.h"
 #include "onedriveurl.h"
@@ -16,12 +18,22 @@
 
 #include <KIO/WorkerBase>
 
+#include <QDeadlineTimer>
+
+#include <functional>
 #include <memory>
+#include <optional>
 
 class AbstractAccountManager;
 
+class QIODevice;
 class QTemporaryFile;
 
+namespace OneDrive
+{
+class QuickXorHash;
+}
+
 class KIOOneDrive : public KIO::WorkerBase
 {
 public:
@@ -86,21 +98,51 @@ private:
     resolveItemForGet(const QUrl &url, const OneDriveUrl &oneDriveUrl, const QString &accountId, const OneDriveAccountPtr &account);
 
     [[nodiscard]] std::pair<KIO::WorkerResult, QString> rootFolderId(const QString &accountId);
-    [[nodiscard]] KIO::WorkerResult listAccountRoot(const QUrl &url, const QString &accountId, const OneDriveAccountPtr &account);
-    [[nodiscard]] KIO::WorkerResult listFolderByPath(const QUrl &url, const QString &accountId, const OneDriveAccountPtr &account, const QString &relativePath);
-    [[nodiscard]] KIO::UDSEntry driveItemToEntry(const OneDrive::DriveItem &item) const;
+    [[nodiscard]] KIO::WorkerResult
+    listAccountRoot(const QUrl &url, const QString &accountId, const OneDriveAccountPtr &account, OneDrive::ItemFields fields);
+    [[nodiscard]] KIO::WorkerResult listFolderByPath(const QUrl &url,
+                                                     const QString &accountId,
+                                                     const OneDriveAccountPtr &account,
+                                                     const QString &relativePath,
+                                                     OneDrive::ItemFields fields);
+    [[nodiscard]] bool revalidateFolderModel(const QString &accountId, const OneDriveAccountPtr &account);
+    [[nodiscard]] KIO::UDSEntry driveItemToEntry(const OneDrive::DriveItem &item, OneDrive::ItemFields fields = OneDrive::ItemField::AllFields) const;
     void cacheSharedWithMeEntries(const QString &accountId, const QList<OneDrive::DriveItem> &items);
 
     [[nodiscard]] KIO::WorkerResult putUpdate(const QUrl &url);
     [[nodiscard]] KIO::WorkerResult putCreate(const QUrl &url);
-    [[nodiscard]] KIO::WorkerResult readPutData(QTemporaryFile &tmpFile, const QString &fileName, QString *detectedMimeType = nullptr);
+    [[nodiscard]] KIO::WorkerResult
+    readPutData(QTemporaryFile &tmpFile, const QString &fileName, QString *detectedMimeType = nullptr, OneDrive::QuickXorHash *hash = nullptr);
+    using PutUploadFunc = std::function<OneDrive::UploadResult(QIODevice *source, const QString &mimeType)>;
+    /**
+     * Uploads the put() data with @p upload. If @p replacedItem has the same size and hash as the data,
+     * nothing is uploaded and @p replacedItem is returned as the result.
+     */
+    [[nodiscard]] std::pair<KIO::WorkerResult, OneDrive::UploadResult>
+    uploadPutData(const QString &fileName, const PutUploadFunc &upload, const OneDrive::DriveItem &replacedItem = OneDrive::DriveItem());
 
     std::unique_ptr<AbstractAccountManager> m_accountManager;
     PathCache m_cache;
+    ItemCache m_itemCache;
     OneDrive::Client m_graphClient;
 
     QMap<QString /* account */, QString /* rootId */> m_rootIds;
     QMap<QString /* account */, QString /* driveType */> m_driveTypes;
+    QMap<QString /* account */, FolderModel> m_folderModels;
+    // Tokens a proactive refresh handed back unchanged, they aren't refreshed again before they expire.
+    QMap<QString /* account */, QString /* token */> m_unrefreshedTokens;
+
+    // Children that came along with the last stat() of a folder, for the listDir() that usually follows.
+    // Every write drops them, they may no longer match the folder afterwards.
+    struct ExpandedFolder {
+        QString path;
+        QList<OneDrive::DriveItem> children;
+        QString nextLink;
+        // Whether the folder model's delta link predates the children, so that they may go into the model.
+        bool deltaLinkKnown = false;
+        QDeadlineTimer expiry;
+    };
+    std::optional<ExpandedFolder> m_expandedFolder;
 };
 
 #endif // KIO_ONEDRIVE_H
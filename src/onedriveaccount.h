@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <QDateTime>
 #include <QString>
 #include <QStringList>
 #include <memory>
@@ -15,6 +16,8 @@ struct OneDriveAccount {
     QString token;
     QString refresh;
     QStringList scopes;
+    // Invalid when the credentials didn't tell.
+    QDateTime expiresAt;
 
     QString accountName() const
     {
@@ -32,6 +35,10 @@ struct OneDriveAccount {
     {
         return !name.isEmpty();
     }
+    bool expiresWithin(qint64 seconds) const
+    {
+        return expiresAt.isValid() && QDateTime::currentDateTimeUtc().secsTo(expiresAt) < seconds;
+    }
 };
 
 using OneDriveAccountPtr = std::shared_ptr<OneDriveAccount>;
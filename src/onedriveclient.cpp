@@ -10,6 +10,7 @@
 
 #include <QByteArray>
 #include <QElapsedTimer>
+#include <QHash>
 #include <QEventLoop>
 #include <QIODevice>
 #include <QJsonArray>
@@ -17,9 +18,19 @@
 #include <QJsonObject>
 #include <QNetworkReply>
 #include <QNetworkRequest>
-#include <QThread>
+#include <QPromise>
+#include <QRandomGenerator>
+#include <QScopeGuard>
+#include <QStandardPaths>
+#include <QTimer>
 #include <QUrl>
 #include <QUrlQuery>
+#include <QtConcurrentRun>
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+#include <vector>
 
 using namespace OneDrive;
 
@@ -28,12 +39,16 @@ namespace
 const QString GraphBaseUrl = QStringLiteral("https://graph.microsoft.com");
 const QString QueryTopKey = QStringLiteral("$top");
 const QString QuerySelectKey = QStringLiteral("$select");
+const QString QueryExpandKey = QStringLiteral("$expand");
 const QString DefaultPageSize = QStringLiteral("200");
 const QString SelectItemFields = QStringLiteral(
-    "id,name,size,parentReference,folder,file,lastModifiedDateTime,createdDateTime,@microsoft.graph.downloadUrl,webUrl,createdBy,lastModifiedBy");
-const QString SelectMinimalItemFields = QStringLiteral("id,name,size,parentReference,folder,file,lastModifiedDateTime,@microsoft.graph.downloadUrl");
-const QString SelectSharedWithMeFields =
-    QStringLiteral("id,name,size,parentReference,folder,file,lastModifiedDateTime,@microsoft.graph.downloadUrl,remoteItem,remoteItem.parentReference");
+    "id,name,size,parentReference,folder,file,eTag,cTag,lastModifiedDateTime,createdDateTime,@microsoft.graph.downloadUrl,webUrl,createdBy,lastModifiedBy");
+const QString SelectMinimalItemFields = QStringLiteral("id,name,size,parentReference,folder,file,eTag,cTag,lastModifiedDateTime,@microsoft.graph.downloadUrl");
+const QString SelectSharedWithMeFields = QStringLiteral(
+    "id,name,size,parentReference,folder,file,eTag,cTag,lastModifiedDateTime,@microsoft.graph.downloadUrl,remoteItem,remoteItem.parentReference");
+const QString SelectDeltaItemFields = QStringLiteral(
+    "id,name,size,parentReference,folder,file,eTag,cTag,deleted,lastModifiedDateTime,createdDateTime,@microsoft.graph.downloadUrl,webUrl,createdBy,"
+    "lastModifiedBy");
 const QString ErrorMissingAccessToken = QStringLiteral("Missing Microsoft Graph access token");
 const QString ErrorMissingAccessTokenOrItemId = QStringLiteral("Missing Microsoft Graph access token or item ID");
 
@@ -42,19 +57,143 @@ const QByteArray HeaderBearerPrefix = QByteArrayLiteral("Bearer ");
 const QByteArray HeaderRequestId = QByteArrayLiteral("request-id");
 const QByteArray HeaderLocation = QByteArrayLiteral("Location");
 const QByteArray HeaderAccept = QByteArrayLiteral("Accept");
+const QByteArray HeaderContentRange = QByteArrayLiteral("Content-Range");
+const QByteArray HeaderRange = QByteArrayLiteral("Range");
+const QByteArray HeaderRetryAfter = QByteArrayLiteral("Retry-After");
+const QByteArray HeaderIfNoneMatch = QByteArrayLiteral("If-None-Match");
+const QByteArray HeaderRateLimitRemaining = QByteArrayLiteral("RateLimit-Remaining");
+const QByteArray HeaderRateLimitReset = QByteArrayLiteral("RateLimit-Reset");
+
+const QByteArray VerbGet = QByteArrayLiteral("GET");
+const QByteArray VerbPost = QByteArrayLiteral("POST");
+const QByteArray VerbPut = QByteArrayLiteral("PUT");
+const QByteArray VerbPatch = QByteArrayLiteral("PATCH");
+const QByteArray VerbDelete = QByteArrayLiteral("DELETE");
 
 const QString MimeApplicationJson = QStringLiteral("application/json");
 const QString MimeOctetStream = QStringLiteral("application/octet-stream");
-const QString MimeDirectory = QStringLiteral("inode/directory");
 
-constexpr int CopyMonitorTimeoutMs = 120000;
-constexpr int CopyMonitorDelayMs = 500;
+// Small copies finish within a second, big folder copies can take many minutes. Poll fast at
+// first and back off, and give up only once the monitor stopped reporting progress for a while.
+constexpr qint64 CopyMonitorStallTimeoutMs = 120000;
+constexpr qint64 InitialCopyMonitorDelayMs = 100;
+constexpr qint64 MaxCopyMonitorDelayMs = 5000;
+
+// Upload session fragments must be multiples of 320 KiB and stay below 60 MiB.
+constexpr qint64 SimpleUploadLimit = 4 * 1024 * 1024;
+constexpr qint64 UploadFragmentAlignment = 320 * 1024;
+constexpr qint64 MinUploadFragmentSize = 4 * UploadFragmentAlignment;
+constexpr qint64 InitialUploadFragmentSize = 10 * UploadFragmentAlignment;
+constexpr qint64 MaxUploadFragmentSize = 180 * UploadFragmentAlignment;
+constexpr qint64 UploadFragmentTargetMs = 5000;
+constexpr int MaxUploadFragmentAttempts = 5;
+constexpr int UploadRetryDelayMs = 1000;
+
+// Ranges ahead of the one being delivered are buffered, which bounds the reorder buffer
+// to (MaxParallelRanges - 1) * DownloadRangeSize.
+constexpr qint64 DownloadRangeSize = 16 * 1024 * 1024;
+constexpr size_t MaxParallelRanges = 4;
+
+// Plain downloads hand data over in chunks that fill up in about DownloadChunkTargetMs: big
+// blocks on fast links keep the per-chunk overhead down, small ones keep slow links responsive.
+constexpr qint64 MinDownloadChunkSize = 16 * 1024;
+constexpr qint64 InitialDownloadChunkSize = 128 * 1024;
+constexpr qint64 MaxDownloadChunkSize = 1024 * 1024;
+constexpr qint64 DownloadChunkTargetMs = 100;
+constexpr qsizetype MaxPooledBufferBytes = 4 * 1024 * 1024;
+
+// Stale tokens whose replacement is remembered, a few per account at most are ever looked up.
+constexpr qsizetype MaxRefreshedTokens = 8;
+
+constexpr qint64 Http2CooldownMs = 10 * 60 * 1000;
+
+// Transfers that moved no bytes in either direction for this long are aborted, a half-open
+// connection would otherwise hang the worker and every job KIO queued behind it.
+constexpr int StallTimeoutMs = 60000;
+
+// Metadata GETs still unanswered after the 95th percentile of recent latencies get a duplicate.
+constexpr qsizetype MinHedgeSamples = 20;
+constexpr qsizetype MaxHedgeSamples = 100;
+constexpr qint64 MinHedgeDelayMs = 50;
+
+// downloadUrl points at one of a handful of storage hosts per account and region.
+constexpr qsizetype MaxRememberedDownloadHosts = 3;
+constexpr quint16 HttpsPort = 443;
+
+// Item lookups revalidated with If-None-Match. A 304 hands back the cached downloadUrl as well, which
+// must not be older than the hour or so that Graph keeps it valid once the worker caches it in turn.
+constexpr qsizetype MaxCachedItemReplies = 1000;
+constexpr qint64 ItemReplyTtlMs = 15 * 60 * 1000;
+
+// Graph asks throttled clients to wait for Retry-After seconds, which can be a minute or more
+// during bulk operations. Give up once a single request waited that long in total.
+constexpr int MaxRequestAttempts = 6;
+constexpr qint64 MaxRetryBudgetMs = 120000;
+constexpr qint64 InitialRetryBackoffMs = 1000;
+constexpr qint64 MaxRetryBackoffMs = 32000;
+
+// Graph only sends RateLimit-* headers once 80% of the quota is used. From then on the remaining
+// resource units are spread evenly over what is left of the window, with a small burst allowance.
+constexpr double MaxPacingBurst = 5;
+
+// Reads whatever @p reply has buffered straight into the spare capacity of @p buffer.
+qint64 appendAvailable(QNetworkReply *reply, QByteArray &buffer)
+{
+    const qsizetype offset = buffer.size();
+    const qint64 available = reply->bytesAvailable();
+    buffer.resize(offset + available);
+    const qint64 received = std::max<qint64>(reply->read(buffer.data() + offset, available), 0);
+    buffer.resize(offset + received);
+    return received;
+}
 
-void waitForFinished(const QNetworkReply *reply)
+// Finds @odata.nextLink in a raw page without parsing the whole document. Strings in JSON escape
+// their quotes, so the key followed by a colon can't be part of an item's data.
+QString scanNextLink(const QByteArray &payload)
 {
-    QEventLoop loop;
-    QObject::connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
-    loop.exec();
+    static const QByteArray key = QByteArrayLiteral("\"@odata.nextLink\"");
+    const qsizetype keyPos = payload.indexOf(key);
+    if (keyPos < 0) {
+        return QString();
+    }
+
+    qsizetype pos = keyPos + key.size();
+    auto skipSpaces = [&payload, &pos]() {
+        while (pos < payload.size() && QChar::isSpace(static_cast<uchar>(payload.at(pos)))) {
+            ++pos;
+        }
+    };
+    skipSpaces();
+    if (pos >= payload.size() || payload.at(pos) != ':') {
+        return QString();
+    }
+    ++pos;
+    skipSpaces();
+    if (pos >= payload.size() || payload.at(pos) != '"') {
+        return QString();
+    }
+
+    const qsizetype start = pos++;
+    while (pos < payload.size() && payload.at(pos) != '"') {
+        pos += payload.at(pos) == '\\' ? 2 : 1;
+    }
+    if (pos >= payload.size()) {
+        return QString();
+    }
+
+    // Let QJsonDocument deal with escape sequences in the link.
+    const QByteArray literal = payload.mid(start, pos - start + 1);
+    return QJsonDocument::fromJson('[' + literal + ']').array().first().toString();
+}
+
+template<typename T>
+QFuture<T> readyFuture(T value)
+{
+    QPromise<T> promise;
+    promise.start();
+    promise.addResult(std::move(value));
+    promise.finish();
+    return promise.future();
 }
 
 template<typename Result>
@@ -73,11 +212,31 @@ QUrl graphUrl(const QString &path, QUrl::ParsingMode parsingMode = QUrl::Decoded
     return url;
 }
 
-QUrlQuery listingQuery()
+// Leaving out what the caller won't show keeps pages small, downloadUrl alone is a few hundred bytes per item.
+QString selectFields(ItemFields fields)
+{
+    if (fields == ItemField::AllFields) {
+        return SelectItemFields;
+    }
+
+    QString selected = QStringLiteral("id,name,size,parentReference,folder,file,eTag,cTag");
+    if (fields & ItemField::Times) {
+        selected += QStringLiteral(",lastModifiedDateTime,createdDateTime");
+    }
+    if (fields & ItemField::Links) {
+        selected += QStringLiteral(",@microsoft.graph.downloadUrl,webUrl");
+    }
+    if (fields & ItemField::People) {
+        selected += QStringLiteral(",createdBy,lastModifiedBy");
+    }
+    return selected;
+}
+
+QUrlQuery listingQuery(ItemFields fields)
 {
     QUrlQuery query;
     query.addQueryItem(QueryTopKey, DefaultPageSize);
-    query.addQueryItem(QuerySelectKey, SelectItemFields);
+    query.addQueryItem(QuerySelectKey, selectFields(fields));
     return query;
 }
 
@@ -95,14 +254,581 @@ QUrlQuery selectQuery(const QString &fields)
     query.addQueryItem(QuerySelectKey, fields);
     return query;
 }
+
+bool isIdempotent(const QByteArray &verb)
+{
+    return verb == VerbGet || verb == VerbPut || verb == VerbDelete;
+}
+
+bool isThrottled(int httpStatus)
+{
+    return httpStatus == 429 || httpStatus == 503;
+}
+
+bool isTransientNetworkError(QNetworkReply::NetworkError error)
+{
+    switch (error) {
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::ProxyTimeoutError:
+    case QNetworkReply::ProtocolFailure:
+    case QNetworkReply::UnknownNetworkError:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Calls @p onStall once @p reply moved no bytes for StallTimeoutMs.
+void watchForStall(QNetworkReply *reply, const std::function<void()> &onStall)
+{
+    auto *timer = new QTimer(reply);
+    timer->setSingleShot(true);
+    timer->setInterval(StallTimeoutMs);
+    auto restart = [timer]() {
+        timer->start();
+    };
+    QObject::connect(reply, &QNetworkReply::downloadProgress, timer, restart);
+    QObject::connect(reply, &QNetworkReply::uploadProgress, timer, restart);
+    QObject::connect(reply, &QNetworkReply::finished, timer, &QTimer::stop);
+    QObject::connect(timer, &QTimer::timeout, reply, onStall);
+    timer->start();
+}
+
+// Set on requests whose caller retries them on its own terms, e.g. upload fragments that resume
+// where the server stopped. The executor sends those only once.
+constexpr auto NoRetryAttribute = static_cast<QNetworkRequest::Attribute>(QNetworkRequest::User + 1);
+
+// Retry-After is either a number of seconds or an HTTP date, -1 if absent or unparsable.
+qint64 parseRetryAfterMs(const QByteArray &value)
+{
+    const QByteArray trimmed = value.trimmed();
+    if (trimmed.isEmpty()) {
+        return -1;
+    }
+    bool ok = false;
+    const qint64 seconds = trimmed.toLongLong(&ok);
+    if (ok) {
+        return seconds < 0 ? -1 : seconds * 1000;
+    }
+    const QDateTime date = QDateTime::fromString(QString::fromLatin1(trimmed), Qt::RFC2822Date);
+    if (!date.isValid()) {
+        return -1;
+    }
+    return std::max<qint64>(QDateTime::currentDateTimeUtc().msecsTo(date), 0);
+}
+
+// Full jitter over an exponentially growing window, so that workers throttled together do not retry together.
+qint64 backoffDelayMs(int attempt)
+{
+    const qint64 window = std::min(InitialRetryBackoffMs << std::min(attempt, 5), MaxRetryBackoffMs);
+    return window / 2 + static_cast<qint64>(QRandomGenerator::global()->bounded(static_cast<quint64>(window / 2 + 1)));
+}
+
+// Approximates the resource unit cost Graph charges for a request: writes cost two units, as do
+// delta queries that start a new enumeration, everything else one.
+double requestCost(const QByteArray &verb, const QUrl &url)
+{
+    if (verb != VerbGet) {
+        return 2;
+    }
+    if (url.path().endsWith(QLatin1String("/delta")) && !QUrlQuery(url).hasQueryItem(QStringLiteral("token"))) {
+        return 2;
+    }
+    return 1;
+}
+
+// Quotas are per user and application, so requests are paced per host and per access token.
+QString rateLimitKey(const QNetworkRequest &request)
+{
+    const QByteArray authorization = request.rawHeader(HeaderAuthorization);
+    return request.url().host() + QLatin1Char('/') + QString::number(qHash(authorization), 16);
+}
+
+QString itemResourcePath(const ItemReference &item)
+{
+    return item.driveId.isEmpty() ? QStringLiteral("/me/drive/items/%1").arg(item.itemId)
+                                  : QStringLiteral("/drives/%1/items/%2").arg(item.driveId, item.itemId);
+}
+
+bool isSuccessStatus(int httpStatus)
+{
+    return httpStatus >= 200 && httpStatus < 300;
+}
+
+QString batchErrorMessage(const BatchResponse &response)
+{
+    const QString message = response.body.value(QStringLiteral("error")).toObject().value(QStringLiteral("message")).toString();
+    return message.isEmpty() ? QStringLiteral("Batched request failed with HTTP status %1").arg(response.httpStatus) : message;
+}
+
+// Size the next fragment so that it takes roughly UploadFragmentTargetMs at the throughput we just measured,
+// without growing or shrinking by more than a factor of two per step.
+qint64 nextUploadFragmentSize(qint64 currentSize, qint64 sentBytes, qint64 elapsedMs)
+{
+    const qint64 bytesPerSecond = sentBytes * 1000 / std::max<qint64>(elapsedMs, 1);
+    const qint64 target = std::clamp(bytesPerSecond * UploadFragmentTargetMs / 1000, currentSize / 2, currentSize * 2);
+    const qint64 aligned = target / UploadFragmentAlignment * UploadFragmentAlignment;
+    return std::clamp(aligned, MinUploadFragmentSize, MaxUploadFragmentSize);
+}
 } // namespace
 
 Client::Client(QObject *parent)
     : QObject(parent)
+    , m_bufferPool(MaxPooledBufferBytes)
+    , m_downloadChunkSize(InitialDownloadChunkSize)
+    , m_downloadHosts(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/kio_onedrive/download-hosts"),
+                      MaxRememberedDownloadHosts)
+    , m_tlsSessions(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/kio_onedrive/tls-sessions"))
+    , m_itemReplies(MaxCachedItemReplies)
+{
+    connect(&m_network, &QNetworkAccessManager::finished, this, &Client::recordReplyProtocol);
+    connect(&m_network, &QNetworkAccessManager::finished, this, &Client::rememberTlsSession);
+}
+
+ProtocolStats Client::protocolStats() const
+{
+    return m_protocolStats;
+}
+
+void Client::setHttp2Enabled(bool enabled)
+{
+    m_http2Enabled = enabled;
+}
+
+bool Client::isHttp2Allowed(const QString &host) const
+{
+    if (!m_http2Enabled) {
+        return false;
+    }
+    const auto it = m_http2Cooldowns.constFind(host);
+    return it == m_http2Cooldowns.cend() || it->hasExpired();
+}
+
+void Client::recordReplyProtocol(QNetworkReply *reply)
+{
+    const bool usedHttp2 = reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool();
+    if (!usedHttp2) {
+        ++m_protocolStats.http1Replies;
+        return;
+    }
+    ++m_protocolStats.http2Replies;
+
+    // These are the errors Graph and the storage hosts produce when an HTTP/2 session breaks
+    // (GOAWAY, stream resets, bogus frames). Keep the host on HTTP/1.1 for a while after one.
+    switch (reply->error()) {
+    case QNetworkReply::ProtocolFailure:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::UnknownNetworkError:
+    case QNetworkReply::ProtocolUnknownError:
+        break;
+    default:
+        return;
+    }
+
+    const QString host = reply->url().host();
+    m_http2Cooldowns.insert(host, QDeadlineTimer(Http2CooldownMs));
+    ++m_protocolStats.http2Fallbacks;
+    qCWarning(ONEDRIVE) << "HTTP/2 failure talking to" << host << reply->errorString() << "- using HTTP/1.1 for the next" << Http2CooldownMs / 1000
+                        << "seconds";
+}
+
+ThrottlingStats Client::throttlingStats() const
+{
+    return m_throttlingStats;
+}
+
+void Client::warmUp()
+{
+    QStringList hosts{QUrl(GraphBaseUrl).host()};
+    hosts += m_downloadHosts.hosts();
+    for (const QString &host : std::as_const(hosts)) {
+        // The connection is only reused by requests that negotiate the same protocols.
+        QSslConfiguration configuration = sslConfiguration(host);
+        if (isHttp2Allowed(host)) {
+            configuration.setAllowedNextProtocols({QSslConfiguration::ALPNProtocolHTTP2, QSslConfiguration::ALPNProtocolHTTP1_1});
+        } else {
+            configuration.setAllowedNextProtocols({QSslConfiguration::ALPNProtocolHTTP1_1});
+        }
+        qCDebug(ONEDRIVE) << "Pre-connecting to" << host << "- resuming a TLS session:" << !configuration.sessionTicket().isEmpty();
+        m_network.connectToHostEncrypted(host, HttpsPort, configuration);
+    }
+}
+
+QSslConfiguration Client::sslConfiguration(const QString &host) const
+{
+    // Qt only hands out session tickets, and takes them back, with session persistence enabled.
+    QSslConfiguration configuration = QSslConfiguration::defaultConfiguration();
+    configuration.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+    configuration.setSessionTicket(m_tlsSessions.ticket(host));
+    return configuration;
+}
+
+void Client::rememberTlsSession(QNetworkReply *reply)
+{
+    const QSslConfiguration configuration = reply->sslConfiguration();
+    m_tlsSessions.insert(reply->url().host(), configuration.sessionTicket(), configuration.sessionTicketLifeTimeHint());
+}
+
+void Client::setTokenRefresher(const TokenRefresher &refresher)
+{
+    m_tokenRefresher = refresher;
+}
+
+qint64 Client::reservePacing(const QString &rateLimitKey, double cost)
+{
+    const auto it = m_rateLimits.find(rateLimitKey);
+    if (it == m_rateLimits.end()) {
+        return 0;
+    }
+    RateLimitBucket &bucket = *it;
+    if (bucket.resetDeadline.hasExpired()) {
+        m_rateLimits.erase(it);
+        return 0;
+    }
+
+    // Tokens may go negative: requests issued while others are still waiting queue up behind them.
+    bucket.tokens = std::min(bucket.capacity, bucket.tokens + bucket.lastRefill.restart() * bucket.refillPerMs) - cost;
+    if (bucket.tokens >= 0) {
+        return 0;
+    }
+
+    // Without refill the quota is gone until the window resets.
+    const qint64 untilReset = bucket.resetDeadline.remainingTime();
+    const qint64 delayMs = bucket.refillPerMs > 0 ? std::min(static_cast<qint64>(-bucket.tokens / bucket.refillPerMs) + 1, untilReset) : untilReset;
+    qCDebug(ONEDRIVE) << "Pacing requests to" << rateLimitKey.section(QLatin1Char('/'), 0, 0) << "for" << delayMs << "ms";
+    ++m_throttlingStats.pacedRequests;
+    m_throttlingStats.pacingDelayMs += delayMs;
+    return delayMs;
+}
+
+void Client::updateRateLimit(const QString &rateLimitKey, const QNetworkReply *reply)
+{
+    bool remainingOk = false;
+    bool resetOk = false;
+    const double remaining = reply->rawHeader(HeaderRateLimitRemaining).trimmed().toDouble(&remainingOk);
+    const qint64 resetSeconds = reply->rawHeader(HeaderRateLimitReset).trimmed().toLongLong(&resetOk);
+    if (!remainingOk || !resetOk || remaining < 0 || resetSeconds <= 0) {
+        return;
+    }
+
+    RateLimitBucket &bucket = m_rateLimits[rateLimitKey];
+    const bool isNew = !bucket.lastRefill.isValid();
+    bucket.capacity = std::clamp(remaining, 0.0, MaxPacingBurst);
+    bucket.refillPerMs = remaining / (resetSeconds * 1000.0);
+    bucket.tokens = isNew ? bucket.capacity : std::min(bucket.tokens, bucket.capacity);
+    bucket.resetDeadline = QDeadlineTimer(resetSeconds * 1000);
+    bucket.lastRefill.start();
+}
+
+struct Client::PendingRequest {
+    QNetworkRequest request;
+    QByteArray verb;
+    QByteArray body;
+    std::function<void(QNetworkReply *)> onStarted;
+    QString pacingKey;
+    double cost = 0;
+    bool idempotent = false;
+    bool retryable = true;
+    bool http2Requested = false;
+    bool tokenRefreshed = false;
+    bool stalled = false;
+    bool canceled = false;
+    int attempt = 0;
+    qint64 waitedMs = 0;
+    QPointer<QTimer> waitTimer;
+    QPointer<QNetworkReply> inFlight;
+    QPromise<QNetworkReply *> promise;
+};
+
+QFuture<QNetworkReply *>
+Client::sendAsync(const QNetworkRequest &request, const QByteArray &verb, const QByteArray &body, const std::function<void(QNetworkReply *)> &onStarted)
+{
+    return startRequest(request, verb, body, onStarted)->promise.future();
+}
+
+std::shared_ptr<Client::PendingRequest> Client::startRequest(const QNetworkRequest &request,
+                                                             const QByteArray &verb,
+                                                             const QByteArray &body,
+                                                             const std::function<void(QNetworkReply *)> &onStarted,
+                                                             qint64 delayMs)
+{
+    auto pending = std::make_shared<PendingRequest>();
+    pending->request = request;
+    pending->verb = verb;
+    pending->body = body;
+    pending->onStarted = onStarted;
+    pending->pacingKey = rateLimitKey(request);
+    pending->cost = requestCost(verb, request.url());
+    pending->idempotent = isIdempotent(verb);
+    pending->retryable = !request.attribute(NoRetryAttribute).toBool();
+    pending->http2Requested = request.attribute(QNetworkRequest::Http2AllowedAttribute).toBool();
+
+    pending->promise.start();
+    if (delayMs > 0) {
+        waitBeforeAttempt(pending, delayMs, &Client::scheduleAttempt);
+    } else {
+        scheduleAttempt(pending);
+    }
+    return pending;
+}
+
+void Client::cancelRequest(const std::shared_ptr<PendingRequest> &pending)
+{
+    if (pending->canceled || pending->promise.future().isFinished()) {
+        return;
+    }
+    pending->canceled = true;
+    pending->promise.future().cancel();
+    delete pending->waitTimer;
+    if (pending->inFlight && !pending->inFlight->isFinished()) {
+        // finishAttempt() finishes the promise once the reply is aborted.
+        pending->inFlight->abort();
+        return;
+    }
+    pending->promise.finish();
+}
+
+QNetworkReply *
+Client::execute(const QNetworkRequest &request, const QByteArray &verb, const QByteArray &body, const std::function<void(QNetworkReply *)> &onStarted)
+{
+    return waitFor(sendAsync(request, verb, body, onStarted));
+}
+
+void Client::scheduleAttempt(const std::shared_ptr<PendingRequest> &pending)
+{
+    if (const qint64 delayMs = reservePacing(pending->pacingKey, pending->cost); delayMs > 0) {
+        waitBeforeAttempt(pending, delayMs, &Client::sendAttempt);
+        return;
+    }
+    sendAttempt(pending);
+}
+
+void Client::waitBeforeAttempt(const std::shared_ptr<PendingRequest> &pending, qint64 delayMs, void (Client::*attempt)(const std::shared_ptr<PendingRequest> &))
+{
+    // Not QTimer::singleShot(), cancelRequest() has to be able to stop the wait.
+    auto *timer = new QTimer(this);
+    timer->setSingleShot(true);
+    connect(timer, &QTimer::timeout, this, [this, pending, timer, attempt]() {
+        timer->deleteLater();
+        (this->*attempt)(pending);
+    });
+    pending->waitTimer = timer;
+    timer->start(delayMs);
+}
+
+void Client::sendAttempt(const std::shared_ptr<PendingRequest> &pending)
+{
+    ++pending->attempt;
+    pending->stalled = false;
+
+    // A previous attempt may have just put the host on HTTP/1.1.
+    QNetworkRequest attemptRequest = pending->request;
+    attemptRequest.setAttribute(QNetworkRequest::Http2AllowedAttribute, pending->http2Requested && isHttp2Allowed(pending->request.url().host()));
+
+    if (!m_firstRequestTimer.isValid()) {
+        m_firstRequestTimer.start();
+        m_protocolStats.firstRequestOfferedTlsTicket = !attemptRequest.sslConfiguration().sessionTicket().isEmpty();
+    }
+
+    // Graph rejects POST, PUT and PATCH requests without a Content-Length with 411, even when there is no body.
+    const bool hasBody = pending->verb == VerbPost || pending->verb == VerbPut || pending->verb == VerbPatch || !pending->body.isEmpty();
+    if (hasBody && pending->body.isEmpty()) {
+        attemptRequest.setHeader(QNetworkRequest::ContentLengthHeader, 0);
+    }
+    QNetworkReply *reply = hasBody ? m_network.sendCustomRequest(attemptRequest, pending->verb, pending->body)
+                                   : m_network.sendCustomRequest(attemptRequest, pending->verb);
+    pending->inFlight = reply;
+    if (pending->onStarted) {
+        pending->onStarted(reply);
+    }
+    watchForStall(reply, [this, pending, reply]() {
+        qCWarning(ONEDRIVE) << pending->verb << pending->request.url().path() << "stalled for" << StallTimeoutMs << "ms, aborting";
+        ++m_protocolStats.stalledReplies;
+        pending->stalled = true;
+        reply->abort();
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, pending, reply]() {
+        finishAttempt(pending, reply);
+    });
+}
+
+void Client::finishAttempt(const std::shared_ptr<PendingRequest> &pending, QNetworkReply *reply)
+{
+    updateRateLimit(pending->pacingKey, reply);
+
+    if (pending->canceled) {
+        reply->deleteLater();
+        pending->promise.finish();
+        return;
+    }
+
+    if (m_protocolStats.firstRequestMs < 0) {
+        m_protocolStats.firstRequestMs = m_firstRequestTimer.elapsed();
+        qCDebug(ONEDRIVE) << "First request took" << m_protocolStats.firstRequestMs << "ms, TLS session ticket offered:"
+                          << m_protocolStats.firstRequestOfferedTlsTicket;
+    }
+
+    auto complete = [&pending, reply]() {
+        pending->promise.addResult(reply);
+        pending->promise.finish();
+    };
+
+    const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (status == 401 && retryWithFreshToken(pending)) {
+        reply->deleteLater();
+        return;
+    }
+
+    const bool throttled = isThrottled(status);
+    if (throttled) {
+        ++m_throttlingStats.throttledReplies;
+    }
+    const bool transient = status == 0 && (pending->stalled || isTransientNetworkError(reply->error()));
+    if (!pending->retryable || (!throttled && !(pending->idempotent && transient))) {
+        complete();
+        return;
+    }
+
+    // A 503 without Retry-After may come from a request that was partially processed, only repeat those that are safe to.
+    qint64 delayMs = parseRetryAfterMs(reply->rawHeader(HeaderRetryAfter));
+    if (delayMs < 0) {
+        if (status == 503 && !pending->idempotent) {
+            complete();
+            return;
+        }
+        delayMs = backoffDelayMs(pending->attempt - 1);
+    }
+
+    const QString path = pending->request.url().path();
+    if (pending->attempt >= MaxRequestAttempts || pending->waitedMs + delayMs > MaxRetryBudgetMs) {
+        ++m_throttlingStats.exhaustedRetries;
+        qCWarning(ONEDRIVE) << "Giving up on" << pending->verb << path << "after" << pending->attempt << "attempts and" << pending->waitedMs
+                            << "ms of waiting," << status << reply->errorString();
+        complete();
+        return;
+    }
+
+    qCInfo(ONEDRIVE) << pending->verb << path << "failed with" << status << reply->errorString() << "- retrying in" << delayMs << "ms";
+    reply->deleteLater();
+    ++m_throttlingStats.retries;
+    m_throttlingStats.retryDelayMs += delayMs;
+    pending->waitedMs += delayMs;
+    waitBeforeAttempt(pending, delayMs, &Client::scheduleAttempt);
+}
+
+bool Client::retryWithFreshToken(const std::shared_ptr<PendingRequest> &pending)
+{
+    const QByteArray authorization = pending->request.rawHeader(HeaderAuthorization);
+    if (!m_tokenRefresher || pending->tokenRefreshed || !authorization.startsWith(HeaderBearerPrefix)) {
+        return false;
+    }
+    pending->tokenRefreshed = true;
+
+    // Requests that were in flight together fail together, only the first one needs to refresh.
+    const QString staleToken = QString::fromUtf8(authorization.mid(HeaderBearerPrefix.size()));
+    QString freshToken = m_refreshedTokens.value(staleToken);
+    if (freshToken.isEmpty()) {
+        freshToken = m_tokenRefresher(staleToken);
+        if (freshToken.isEmpty() || freshToken == staleToken) {
+            qCWarning(ONEDRIVE) << "Access token was rejected and could not be refreshed";
+            return false;
+        }
+        // Only requests that were in flight with a stale token look it up, older ones are of no use.
+        if (m_refreshedTokens.size() >= MaxRefreshedTokens) {
+            m_refreshedTokens.clear();
+        }
+        m_refreshedTokens.insert(staleToken, freshToken);
+    }
+
+    qCInfo(ONEDRIVE) << pending->verb << pending->request.url().path() << "was rejected with 401 - retrying with a refreshed token";
+    pending->request.setRawHeader(HeaderAuthorization, HeaderBearerPrefix + freshToken.toUtf8());
+    scheduleAttempt(pending);
+    return true;
+}
+
+void Client::recordMetadataLatency(qint64 latencyMs)
 {
+    if (m_metadataLatencies.size() >= MaxHedgeSamples) {
+        m_metadataLatencies.removeFirst();
+    }
+    m_metadataLatencies.append(latencyMs);
+}
+
+qint64 Client::hedgeDelayMs(const QNetworkRequest &request) const
+{
+    // Don't add load while Graph is asking us to slow down.
+    const auto bucket = m_rateLimits.constFind(rateLimitKey(request));
+    if (bucket != m_rateLimits.constEnd() && !bucket->resetDeadline.hasExpired()) {
+        return -1;
+    }
+    if (m_metadataLatencies.size() < MinHedgeSamples) {
+        return -1;
+    }
+
+    QList<qint64> latencies = m_metadataLatencies;
+    const auto p95 = latencies.begin() + latencies.size() * 95 / 100;
+    std::nth_element(latencies.begin(), p95, latencies.end());
+    return std::max(*p95, MinHedgeDelayMs);
+}
+
+QFuture<QNetworkReply *> Client::sendHedgedAsync(const QNetworkRequest &request)
+{
+    struct Hedge {
+        QPromise<QNetworkReply *> promise;
+        QList<QPointer<QNetworkReply>> attempts;
+        QElapsedTimer elapsed;
+        bool settled = false;
+    };
+    auto hedge = std::make_shared<Hedge>();
+    hedge->promise.start();
+    hedge->elapsed.start();
+
+    auto onStarted = [hedge](QNetworkReply *reply) {
+        hedge->attempts.append(reply);
+    };
+    auto settle = [this, hedge](QNetworkReply *reply, bool hedged) {
+        if (hedge->settled) {
+            reply->deleteLater();
+            return;
+        }
+        hedge->settled = true;
+        recordMetadataLatency(hedge->elapsed.elapsed());
+        if (hedged) {
+            ++m_protocolStats.hedgesWon;
+        }
+        for (const QPointer<QNetworkReply> &attempt : std::as_const(hedge->attempts)) {
+            if (attempt && attempt != reply && attempt->isRunning()) {
+                attempt->abort();
+            }
+        }
+        hedge->promise.addResult(reply);
+        hedge->promise.finish();
+    };
+
+    const qint64 delayMs = hedgeDelayMs(request);
+    sendAsync(request, VerbGet, QByteArray(), onStarted).then(this, [settle](QNetworkReply *reply) {
+        settle(reply, false);
+    });
+    if (delayMs >= 0) {
+        QTimer::singleShot(delayMs, this, [this, hedge, request, onStarted, settle]() {
+            if (hedge->settled) {
+                return;
+            }
+            ++m_protocolStats.hedgedRequests;
+            qCDebug(ONEDRIVE) << "No reply to" << request.url().path() << "yet, sending a hedged request";
+            sendAsync(request, VerbGet, QByteArray(), onStarted).then(this, [settle](QNetworkReply *reply) {
+                settle(reply, true);
+            });
+        });
+    }
+    return hedge->promise.future();
 }
 
-ListChildrenResult Client::listChildren(const QString &accessToken, const QString &driveId, const QString &itemId)
+ListChildrenResult
+Client::listChildren(const QString &accessToken, const QString &driveId, const QString &itemId, const ListPageHandler &onPage, ItemFields fields)
 {
     if (accessToken.isEmpty()) {
         return unauthorizedResult<ListChildrenResult>(ErrorMissingAccessToken);
@@ -114,19 +840,17 @@ ListChildrenResult Client::listChildren(const QString &accessToken, const QStrin
                                         : QStringLiteral("/v1.0/drives/%1/items/%2/children").arg(driveId, itemId));
     }
 
-    QUrlQuery query = listingQuery();
+    QUrlQuery query = listingQuery(fields);
     url.setQuery(query);
 
-    return fetchPagedList(accessToken, url, [](const QJsonObject &obj, ListChildrenResult &res) {
-        res.items.append(parseItem(obj));
-    });
+    return fetchPagedList(accessToken, url, ListItemSource::Item, onPage);
 }
 
-ListChildrenResult Client::listChildrenByPath(const QString &accessToken, const QString &relativePath)
+ListChildrenResult Client::listChildrenByPath(const QString &accessToken, const QString &relativePath, const ListPageHandler &onPage, ItemFields fields)
 {
     const QString cleanedPath = relativePath.trimmed();
     if (cleanedPath.isEmpty()) {
-        return listChildren(accessToken);
+        return listChildren(accessToken, QString(), QString(), onPage, fields);
     }
 
     if (accessToken.isEmpty()) {
@@ -135,54 +859,78 @@ ListChildrenResult Client::listChildrenByPath(const QString &accessToken, const
 
     QUrl url = graphUrl(QStringLiteral("/v1.0/me/drive/root:/%1:/children").arg(cleanedPath), QUrl::DecodedMode);
 
-    QUrlQuery query = listingQuery();
+    QUrlQuery query = listingQuery(fields);
     url.setQuery(query);
 
-    return fetchPagedList(accessToken, url, [](const QJsonObject &obj, ListChildrenResult &res) {
-        res.items.append(parseItem(obj));
-    });
+    return fetchPagedList(accessToken, url, ListItemSource::Item, onPage);
+}
+
+ListChildrenResult Client::continueListing(const QString &accessToken, const QString &nextLink, const ListPageHandler &onPage)
+{
+    if (accessToken.isEmpty()) {
+        return unauthorizedResult<ListChildrenResult>(ErrorMissingAccessToken);
+    }
+    return fetchPagedList(accessToken, QUrl(nextLink), ListItemSource::Item, onPage);
 }
 
-DriveItemResult Client::getItemByPath(const QString &accessToken, const QString &relativePath)
+DriveItemResult Client::readItemReply(QNetworkReply *reply)
 {
     DriveItemResult result;
+    reply->deleteLater();
+    result.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (reply->error() != QNetworkReply::NoError) {
+        result.errorMessage = reply->errorString();
+        return result;
+    }
+
+    const QJsonObject object = QJsonDocument::fromJson(reply->readAll()).object();
+    result.item = parseDriveItem(object);
+    result.success = true;
+
+    if (const QJsonValue children = object.value(QStringLiteral("children")); children.isArray()) {
+        const QJsonArray values = children.toArray();
+        const qsizetype childCount = object.value(QStringLiteral("folder")).toObject().value(QStringLiteral("childCount")).toInteger(-1);
+        result.childrenNextLink = object.value(QStringLiteral("children@odata.nextLink")).toString();
+        // Without a next link the expansion has to hold every child, otherwise it was cut short.
+        if (!result.childrenNextLink.isEmpty() || childCount < 0 || values.size() >= childCount) {
+            result.childrenExpanded = true;
+            for (const QJsonValue &value : values) {
+                result.children.append(parseDriveItem(value.toObject()));
+            }
+        }
+    }
+    return result;
+}
+
+QFuture<DriveItemResult> Client::getItemByPathAsync(const QString &accessToken, const QString &relativePath, bool expandChildren, ItemFields fields)
+{
     if (accessToken.isEmpty()) {
-        return unauthorizedResult<DriveItemResult>(ErrorMissingAccessToken);
+        return readyFuture(unauthorizedResult<DriveItemResult>(ErrorMissingAccessToken));
     }
 
     const QString cleanedPath = relativePath.trimmed();
     QUrl url = graphUrl(cleanedPath.isEmpty() ? QStringLiteral("/v1.0/me/drive/root") : QStringLiteral("/v1.0/me/drive/root:/%1:").arg(cleanedPath),
                         QUrl::DecodedMode);
 
-    QUrlQuery query = selectQuery(SelectItemFields);
+    QUrlQuery query = selectQuery(selectFields(fields));
+    if (expandChildren) {
+        query.addQueryItem(QueryExpandKey, QStringLiteral("children($select=%1)").arg(SelectItemFields));
+    }
     url.setQuery(query);
 
-    const QNetworkRequest request = buildRequest(accessToken, url);
-    QNetworkReply *reply = m_network.get(request);
-    waitForFinished(reply);
-
-    if (reply->error() != QNetworkReply::NoError) {
-        result.errorMessage = reply->errorString();
-        result.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-        const QString requestId = QString::fromUtf8(reply->rawHeader(HeaderRequestId));
-        qCWarning(ONEDRIVE) << "Graph getItemByPath failed" << url << result.httpStatus << result.errorMessage << "requestId:" << requestId;
-        reply->deleteLater();
-        return result;
-    }
+    // A folder's eTag doesn't tell whether its children changed, expanded lookups are always fetched.
+    return fetchItemAsync(accessToken, url, !expandChildren, "getItemByPath");
+}
 
-    const QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
-    result.item = parseItem(doc.object());
-    result.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-    reply->deleteLater();
-    result.success = true;
-    return result;
+DriveItemResult Client::getItemByPath(const QString &accessToken, const QString &relativePath, bool expandChildren, ItemFields fields)
+{
+    return waitFor(getItemByPathAsync(accessToken, relativePath, expandChildren, fields));
 }
 
-DriveItemResult Client::getItemById(const QString &accessToken, const QString &driveId, const QString &itemId)
+QFuture<DriveItemResult> Client::getItemByIdAsync(const QString &accessToken, const QString &driveId, const QString &itemId)
 {
-    DriveItemResult result;
     if (accessToken.isEmpty() || itemId.isEmpty()) {
-        return unauthorizedResult<DriveItemResult>(QStringLiteral("Missing Microsoft Graph access token or drive item information"));
+        return readyFuture(unauthorizedResult<DriveItemResult>(QStringLiteral("Missing Microsoft Graph access token or drive item information")));
     }
 
     QUrl url =
@@ -190,30 +938,19 @@ DriveItemResult Client::getItemById(const QString &accessToken, const QString &d
     QUrlQuery query = selectQuery(SelectMinimalItemFields);
     url.setQuery(query);
 
-    const QNetworkRequest request = buildRequest(accessToken, url);
-    QNetworkReply *reply = m_network.get(request);
-    waitForFinished(reply);
-
-    if (reply->error() != QNetworkReply::NoError) {
-        result.errorMessage = reply->errorString();
-        result.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-        reply->deleteLater();
-        return result;
-    }
+    return fetchItemAsync(accessToken, url, true);
+}
 
-    const QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
-    result.item = parseItem(doc.object());
-    result.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-    reply->deleteLater();
-    result.success = true;
-    return result;
+DriveItemResult Client::getItemById(const QString &accessToken, const QString &driveId, const QString &itemId)
+{
+    return waitFor(getItemByIdAsync(accessToken, driveId, itemId));
 }
 
-DriveItemResult Client::getDriveItemByPath(const QString &accessToken, const QString &driveId, const QString &itemId, const QString &relativePath)
+QFuture<DriveItemResult>
+Client::getDriveItemByPathAsync(const QString &accessToken, const QString &driveId, const QString &itemId, const QString &relativePath)
 {
-    DriveItemResult result;
     if (accessToken.isEmpty() || driveId.isEmpty() || itemId.isEmpty()) {
-        return unauthorizedResult<DriveItemResult>(QStringLiteral("Missing Microsoft Graph access token or drive information"));
+        return readyFuture(unauthorizedResult<DriveItemResult>(QStringLiteral("Missing Microsoft Graph access token or drive information")));
     }
 
     QUrl url = graphUrl(QStringLiteral("/v1.0/drives/%1/items/%2").arg(driveId, itemId));
@@ -224,30 +961,55 @@ DriveItemResult Client::getDriveItemByPath(const QString &accessToken, const QSt
     QUrlQuery query = selectQuery(SelectMinimalItemFields);
     url.setQuery(query);
 
-    const QNetworkRequest request = buildRequest(accessToken, url);
-    QNetworkReply *reply = m_network.get(request);
-    waitForFinished(reply);
+    return fetchItemAsync(accessToken, url, true);
+}
 
-    if (reply->error() != QNetworkReply::NoError) {
-        result.errorMessage = reply->errorString();
-        result.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-        reply->deleteLater();
-        return result;
+QFuture<DriveItemResult> Client::fetchItemAsync(const QString &accessToken, const QUrl &url, bool revalidate, const char *label)
+{
+    QNetworkRequest request = buildRequest(accessToken, url);
+    const QString cacheKey = url.toString(QUrl::FullyEncoded);
+
+    // Copied now, so that a 304 is answered even if the entry is evicted while the request is in flight.
+    std::optional<DriveItemResult> cached;
+    if (revalidate) {
+        if (const CachedItemReply *entry = m_itemReplies.object(cacheKey); entry && !entry->expiry.hasExpired()) {
+            cached = entry->result;
+            request.setRawHeader(HeaderIfNoneMatch, entry->result.item.eTag.toUtf8());
+        }
     }
 
-    const QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
-    result.item = parseItem(doc.object());
-    result.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-    reply->deleteLater();
-    result.success = true;
-    return result;
+    return sendHedgedAsync(request).then(this, [this, url, cacheKey, revalidate, cached, label](QNetworkReply *reply) {
+        if (cached && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304) {
+            reply->deleteLater();
+            ++m_protocolStats.notModifiedReplies;
+            return *cached;
+        }
+
+        const DriveItemResult result = readItemReply(reply);
+        if (!result.success) {
+            m_itemReplies.remove(cacheKey);
+            if (label) {
+                const QString requestId = QString::fromUtf8(reply->rawHeader(HeaderRequestId));
+                qCWarning(ONEDRIVE) << "Graph" << label << "failed" << url << result.httpStatus << result.errorMessage << "requestId:" << requestId;
+            }
+        } else if (revalidate && !result.item.eTag.isEmpty()) {
+            // Keyed by URL only: the same path under another account has another eTag and is simply refetched.
+            m_itemReplies.insert(cacheKey, new CachedItemReply{result, QDeadlineTimer(ItemReplyTtlMs)});
+        }
+        return result;
+    });
+}
+
+DriveItemResult Client::getDriveItemByPath(const QString &accessToken, const QString &driveId, const QString &itemId, const QString &relativePath)
+{
+    return waitFor(getDriveItemByPathAsync(accessToken, driveId, itemId, relativePath));
 }
 
 DownloadResult Client::downloadItem(const QString &accessToken, const QString &itemId, const QString &downloadUrl, const QString &driveId)
 {
     // Refactored to use streaming download internally to avoid duplicating the download logic
     QByteArray bufferedData;
-    const auto streamResult = streamDownloadItem(accessToken, itemId, downloadUrl, driveId, [&bufferedData](const QByteArray &chunk) {
+    const auto streamResult = streamDownloadItem(accessToken, itemId, downloadUrl, driveId, 0, [&bufferedData](const QByteArray &chunk) {
         bufferedData.append(chunk);
         return true;
     });
@@ -288,19 +1050,59 @@ DownloadStreamResult Client::performDownload(QNetworkRequest req,
 
         QNetworkReply *reply = m_network.get(currentReq);
         bool abortedByConsumer = false;
+        bool stalled = false;
+        watchForStall(reply, [this, reply, &stalled]() {
+            ++m_protocolStats.stalledReplies;
+            stalled = true;
+            reply->abort();
+        });
+        QByteArray buffer = m_bufferPool.acquire(m_downloadChunkSize);
+        const auto releaseBuffer = qScopeGuard([this, &buffer]() {
+            m_bufferPool.release(std::move(buffer));
+        });
+        QElapsedTimer sinceChunk;
+
+        // Reads the next chunk into the reused buffer and hands it over. Returns false once the consumer asked to stop.
+        auto deliverChunk = [&]() {
+            const qint64 wanted = std::min(reply->bytesAvailable(), m_downloadChunkSize);
+            buffer.resize(wanted);
+            buffer.resize(std::max<qint64>(reply->read(buffer.data(), wanted), 0));
+            if (buffer.isEmpty()) {
+                return true;
+            }
 
-        QObject::connect(reply, &QNetworkReply::readyRead, reply, [&reply, &onChunk, &abortedByConsumer]() {
-            while (reply->bytesAvailable() > 0) {
-                const QByteArray chunk = reply->read(128 * 1024);
-                if (chunk.isEmpty()) {
-                    break;
-                }
-                if (!onChunk(chunk)) {
+            const qint64 elapsedMs = sinceChunk.restart();
+            if (buffer.size() == m_downloadChunkSize && elapsedMs < DownloadChunkTargetMs / 2) {
+                m_downloadChunkSize = std::min(m_downloadChunkSize * 2, MaxDownloadChunkSize);
+            } else if (elapsedMs > 2 * DownloadChunkTargetMs) {
+                m_downloadChunkSize = std::max(m_downloadChunkSize / 2, MinDownloadChunkSize);
+            }
+            return onChunk(buffer);
+        };
+        auto deliverAvailable = [&](bool partialChunks) {
+            while (reply->bytesAvailable() >= m_downloadChunkSize || (reply->bytesAvailable() > 0 && partialChunks)) {
+                if (!deliverChunk()) {
                     abortedByConsumer = true;
                     reply->abort();
-                    break;
+                    return;
+                }
+                if (buffer.isEmpty()) {
+                    return;
                 }
             }
+        };
+
+        QObject::connect(reply, &QNetworkReply::readyRead, reply, [&]() {
+            // Redirect and error bodies are not part of the file.
+            const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            if (abortedByConsumer || status < 200 || status >= 300) {
+                return;
+            }
+            if (!sinceChunk.isValid()) {
+                sinceChunk.start();
+            }
+            // Let data pile up to a full chunk unless it has been waiting for a while already.
+            deliverAvailable(sinceChunk.elapsed() >= DownloadChunkTargetMs);
         });
 
         // TODO: drop the nested loop and drive completion via event loop/signals, handling cancellation and timeouts properly
@@ -331,56 +1133,257 @@ DownloadStreamResult Client::performDownload(QNetworkRequest req,
             return res;
         }
 
+        if (reply->error() == QNetworkReply::NoError && reply->bytesAvailable() > 0) {
+            if (!sinceChunk.isValid()) {
+                sinceChunk.start();
+            }
+            deliverAvailable(true);
+            if (abortedByConsumer) {
+                res.errorMessage = QStringLiteral("Download aborted");
+                res.httpStatus = status;
+                reply->deleteLater();
+                return res;
+            }
+        }
+
         if (reply->error() != QNetworkReply::NoError) {
-            qCWarning(ONEDRIVE) << "Download attempt" << label << "failed" << req.url() << status << reply->errorString();
-            res.errorMessage = reply->errorString();
+            qCWarning(ONEDRIVE) << "Download attempt" << label << "failed" << req.url() << status << reply->errorString() << "stalled:" << stalled;
+            res.errorMessage = stalled ? QStringLiteral("Download stalled") : reply->errorString();
             res.httpStatus = status;
             reply->deleteLater();
             return res;
         }
 
-        res.httpStatus = status;
-        res.success = true;
-        reply->deleteLater();
-        return res;
+        res.httpStatus = status;
+        res.success = true;
+        reply->deleteLater();
+        return res;
+    }
+
+    res.errorMessage = QStringLiteral("Too many redirects");
+    res.httpStatus = 310;
+    return res;
+}
+
+DownloadStreamResult Client::performRangedDownload(const QUrl &url, qint64 totalSize, const std::function<bool(const QByteArray &)> &onChunk)
+{
+    struct Range {
+        qint64 start = 0;
+        qint64 end = 0;
+        qint64 received = 0;
+        QNetworkReply *reply = nullptr;
+        QByteArray pending;
+        bool done = false;
+    };
+
+    std::vector<Range> ranges;
+    for (qint64 start = 0; start < totalSize; start += DownloadRangeSize) {
+        Range range;
+        range.start = start;
+        range.end = std::min(start + DownloadRangeSize, totalSize) - 1;
+        ranges.push_back(range);
+    }
+
+    DownloadStreamResult res;
+    QEventLoop loop;
+    BufferPool rangeBuffers(MaxParallelRanges * DownloadRangeSize);
+    size_t nextToIssue = 0;
+    size_t nextToDeliver = 0;
+    bool stopped = false;
+
+    auto stop = [&](int status, const QString &message) {
+        if (stopped) {
+            return;
+        }
+        stopped = true;
+        res.httpStatus = status;
+        res.errorMessage = message;
+        for (auto &range : ranges) {
+            if (QNetworkReply *reply = std::exchange(range.reply, nullptr)) {
+                reply->abort();
+                reply->deleteLater();
+            }
+        }
+        loop.quit();
+    };
+
+    // Hands buffered data to the consumer strictly in range order.
+    auto deliver = [&]() {
+        while (!stopped && nextToDeliver < ranges.size()) {
+            Range &range = ranges[nextToDeliver];
+            if (!range.pending.isEmpty()) {
+                QByteArray chunk = std::exchange(range.pending, QByteArray());
+                const bool keepGoing = onChunk(chunk);
+                rangeBuffers.release(std::move(chunk));
+                if (!keepGoing) {
+                    stop(206, QStringLiteral("Download aborted"));
+                    return;
+                }
+            }
+            if (!range.done) {
+                return;
+            }
+            ++nextToDeliver;
+        }
+    };
+
+    std::function<void()> issueMore = [&]() {
+        while (!stopped && nextToIssue < ranges.size() && nextToIssue < nextToDeliver + MaxParallelRanges) {
+            const size_t index = nextToIssue++;
+            Range &range = ranges[index];
+
+            QNetworkRequest request = buildRequest(QString(), url);
+            request.setRawHeader(HeaderAuthorization, QByteArray());
+            request.setRawHeader(HeaderRange, QStringLiteral("bytes=%1-%2").arg(range.start).arg(range.end).toLatin1());
+            // The point is to spread ranges over several TCP connections, not to multiplex them on one.
+            request.setAttribute(QNetworkRequest::Http2AllowedAttribute, false);
+            QNetworkReply *reply = m_network.get(request);
+            range.reply = reply;
+            range.pending = rangeBuffers.acquire(range.end - range.start + 1);
+            watchForStall(reply, [this, reply]() {
+                ++m_protocolStats.stalledReplies;
+                reply->abort();
+            });
+
+            QObject::connect(reply, &QNetworkReply::readyRead, reply, [&, reply, index]() {
+                if (stopped) {
+                    return;
+                }
+                const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+                if (status != 206) {
+                    stop(status, QStringLiteral("Storage host did not honor the byte range request"));
+                    return;
+                }
+                Range &current = ranges[index];
+                current.received += appendAvailable(reply, current.pending);
+                if (index == nextToDeliver) {
+                    deliver();
+                }
+            });
+
+            QObject::connect(reply, &QNetworkReply::finished, reply, [&, reply, index]() {
+                if (stopped) {
+                    return;
+                }
+                Range &current = ranges[index];
+                current.reply = nullptr;
+                reply->deleteLater();
+
+                const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+                if (reply->error() != QNetworkReply::NoError) {
+                    qCWarning(ONEDRIVE) << "Download range" << current.start << current.end << "failed" << status << reply->errorString();
+                    stop(status, reply->errorString());
+                    return;
+                }
+                if (status != 206) {
+                    stop(status, QStringLiteral("Storage host did not honor the byte range request"));
+                    return;
+                }
+
+                current.received += appendAvailable(reply, current.pending);
+                if (current.received != current.end - current.start + 1) {
+                    stop(status, QStringLiteral("Download range ended early"));
+                    return;
+                }
+                current.done = true;
+
+                deliver();
+                issueMore();
+                if (!stopped && nextToDeliver == ranges.size()) {
+                    res.success = true;
+                    res.httpStatus = 200;
+                    loop.quit();
+                }
+            });
+        }
+    };
+
+    issueMore();
+    if (!stopped) {
+        loop.exec();
     }
-
-    res.errorMessage = QStringLiteral("Too many redirects");
-    res.httpStatus = 310;
     return res;
 }
 
-void Client::parseListPayload(const QByteArray &payload,
-                              ListChildrenResult &res,
-                              const std::function<void(const QJsonObject &, ListChildrenResult &)> &append) const
+ListChildrenResult Client::fetchPagedList(const QString &accessToken, const QUrl &url, ListItemSource source, const ListPageHandler &onPage)
 {
-    const QJsonDocument doc = QJsonDocument::fromJson(payload);
-    const QJsonObject root = doc.object();
-    const QJsonArray values = root.value(QStringLiteral("value")).toArray();
-    res.nextLink = root.value(QStringLiteral("@odata.nextLink")).toString();
+    ListChildrenResult result;
+    QList<QFuture<ListPage>> pages;
 
-    for (const QJsonValue &value : values) {
-        append(value.toObject(), res);
-    }
-}
+    // Request page N+1 as soon as its link is known and parse page N on the thread pool meanwhile,
+    // so listing time is dominated by the network rather than by JSON parsing.
+    auto parsePage = [source](const QByteArray &payload) {
+        return QtConcurrent::run([source, payload]() {
+            return parseListPage(payload, source);
+        });
+    };
 
-ListChildrenResult
-Client::fetchPagedList(const QString &accessToken, const QUrl &url, const std::function<void(const QJsonObject &, ListChildrenResult &)> &append)
-{
-    ListChildrenResult result;
-    QUrl nextUrl = url;
+    auto requestPage = [&](const QUrl &pageUrl) {
+        return startRequest(buildRequest(accessToken, pageUrl), VerbGet);
+    };
+
+    std::shared_ptr<PendingRequest> nextPage = requestPage(url);
+    bool morePages = true;
 
-    while (!nextUrl.isEmpty()) {
-        QNetworkReply *reply = m_network.get(buildRequest(accessToken, nextUrl));
-        waitForFinished(reply);
+    // The next page may be waiting out a retry delay, don't wait for it.
+    auto abandonNextPage = [&]() {
+        if (morePages) {
+            cancelRequest(nextPage);
+        }
+    };
+
+    while (morePages) {
+        QNetworkReply *reply = waitFor(nextPage->promise.future());
         QByteArray payload = readReply(reply, result);
         if (!result.success) {
             return result;
         }
-        parseListPayload(payload, result, append);
-        nextUrl = QUrl(result.nextLink);
+
+        QString nextLink = scanNextLink(payload);
+        QFuture<ListPage> page = parsePage(payload);
+        if (nextLink.isEmpty()) {
+            // The scan only looks for the usual layout, trust the parser if it finds a link anyway.
+            nextLink = page.result().nextLink;
+        }
+
+        morePages = !nextLink.isEmpty();
+        if (morePages) {
+            nextPage = requestPage(QUrl(nextLink));
+        }
+
+        if (!onPage) {
+            pages.append(page);
+            continue;
+        }
+
+        // Hand this page over while the next one is on the wire.
+        const ListPage parsed = page.result();
+        if (!parsed.valid) {
+            abandonNextPage();
+            result.success = false;
+            result.errorMessage = QStringLiteral("Malformed listing page");
+            return result;
+        }
+        result.deltaLink = parsed.deltaLink;
+        if (!onPage(parsed.items)) {
+            abandonNextPage();
+            result.success = false;
+            result.errorMessage = QStringLiteral("Listing aborted");
+            return result;
+        }
     }
 
+    for (QFuture<ListPage> &page : pages) {
+        const ListPage parsed = page.result();
+        if (!parsed.valid) {
+            result.success = false;
+            result.errorMessage = QStringLiteral("Malformed listing page");
+            return result;
+        }
+        result.items.append(parsed.items);
+        result.deltaLink = parsed.deltaLink;
+    }
+    result.nextLink.clear();
     result.success = true;
     return result;
 }
@@ -389,6 +1392,7 @@ DownloadStreamResult Client::streamDownloadItem(const QString &accessToken,
                                                 const QString &itemId,
                                                 const QString &downloadUrl,
                                                 const QString &driveId,
+                                                qint64 itemSize,
                                                 const std::function<bool(const QByteArray &)> &onChunk)
 {
     DownloadStreamResult result;
@@ -404,50 +1408,103 @@ DownloadStreamResult Client::streamDownloadItem(const QString &accessToken,
         return result;
     }
 
-    QString resolvedDownloadUrl = downloadUrl;
-    if (resolvedDownloadUrl.isEmpty()) {
-        const auto refreshedItem = getItemById(accessToken, driveId, itemId);
-        if (refreshedItem.success && !refreshedItem.item.downloadUrl.isEmpty()) {
-            resolvedDownloadUrl = refreshedItem.item.downloadUrl;
-        } else if (!refreshedItem.success) {
-            qCWarning(ONEDRIVE) << "Could not refresh download URL for item" << itemId << refreshedItem.httpStatus << refreshedItem.errorMessage;
-        }
+    // Signed URL (anonymous) first, then drive-scoped content. Item IDs are drive-scoped, so /me
+    // content is only an option when the drive is unknown.
+    QList<DownloadStrategy> strategies{DownloadStrategy::SignedUrl};
+    strategies.append(driveId.isEmpty() ? DownloadStrategy::MeContent : DownloadStrategy::DriveContent);
+
+    // Some drives, e.g. shared ones, never work with the first choice. Don't pay for it on every download.
+    const QString strategyKey = driveId.isEmpty() ? QStringLiteral("me") : driveId;
+    const std::optional<DownloadStrategy> remembered =
+        m_downloadStrategies.contains(strategyKey) ? std::optional(m_downloadStrategies.value(strategyKey)) : std::nullopt;
+    if (remembered) {
+        strategies.removeAll(*remembered);
+        strategies.prepend(*remembered);
     }
 
-    // Preferred: signed URL (anonymous)
-    if (!resolvedDownloadUrl.isEmpty()) {
-        QNetworkRequest fallbackReq{QUrl(resolvedDownloadUrl)};
-        result = performDownload(fallbackReq, accessToken, onChunk, false, "signed-url-anon");
+    qint64 delivered = 0;
+    bool consumerStopped = false;
+    auto countingOnChunk = [&](const QByteArray &chunk) {
+        delivered += chunk.size();
+        consumerStopped = !onChunk(chunk);
+        return !consumerStopped;
+    };
+
+    // Signed URLs expire and ours may come from a cache, failing to get one or having it rejected
+    // says nothing about the drive. Other strategies that work then aren't remembered over it.
+    bool signedUrlUnusable = false;
+
+    for (const DownloadStrategy strategy : std::as_const(strategies)) {
+        switch (strategy) {
+        case DownloadStrategy::SignedUrl: {
+            QString resolvedDownloadUrl = downloadUrl;
+            if (resolvedDownloadUrl.isEmpty()) {
+                const auto refreshedItem = getItemById(accessToken, driveId, itemId);
+                if (refreshedItem.success && !refreshedItem.item.downloadUrl.isEmpty()) {
+                    resolvedDownloadUrl = refreshedItem.item.downloadUrl;
+                } else if (!refreshedItem.success) {
+                    qCWarning(ONEDRIVE) << "Could not refresh download URL for item" << itemId << refreshedItem.httpStatus << refreshedItem.errorMessage;
+                }
+            }
+            if (resolvedDownloadUrl.isEmpty()) {
+                qCWarning(ONEDRIVE) << "Download URL missing for item" << itemId << "- falling back to Graph content endpoints";
+                result.errorMessage = QStringLiteral("Download URL missing");
+                signedUrlUnusable = true;
+                break;
+            }
+
+            m_downloadHosts.recordHost(QUrl(resolvedDownloadUrl).host());
+            if (itemSize >= RangedDownloadThreshold) {
+                result = performRangedDownload(QUrl(resolvedDownloadUrl), itemSize, countingOnChunk);
+                if (result.success || delivered > 0) {
+                    break;
+                }
+                qCDebug(ONEDRIVE) << "Ranged download of" << itemId << "failed before delivering data, falling back to a single stream"
+                                  << result.httpStatus << result.errorMessage;
+            }
+            result = performDownload(QNetworkRequest(QUrl(resolvedDownloadUrl)), accessToken, countingOnChunk, false, "signed-url-anon");
+            signedUrlUnusable = result.httpStatus == 401 || result.httpStatus == 403;
+            break;
+        }
+        case DownloadStrategy::DriveContent: {
+            const QUrl driveUrl = graphUrl(QStringLiteral("/v1.0/drives/%1/items/%2/content").arg(driveId, itemId));
+            result = performDownload(buildRequest(accessToken, driveUrl), accessToken, countingOnChunk, true, "drive-content");
+            break;
+        }
+        case DownloadStrategy::MeContent: {
+            const QUrl meUrl = graphUrl(QStringLiteral("/v1.0/me/drive/items/%1/content").arg(itemId));
+            result = performDownload(buildRequest(accessToken, meUrl), accessToken, countingOnChunk, true, "me-content");
+            break;
+        }
+        }
+
         if (result.success) {
+            if (strategy == DownloadStrategy::SignedUrl || !signedUrlUnusable) {
+                m_downloadStrategies.insert(strategyKey, strategy);
+            }
+            return result;
+        }
+        // A consumer that stopped reading or a bad signed URL doesn't make the strategy a bad choice for the drive.
+        const bool urlProblem = strategy == DownloadStrategy::SignedUrl && signedUrlUnusable;
+        if (remembered == strategy && !consumerStopped && !urlProblem) {
+            m_downloadStrategies.remove(strategyKey);
+        }
+        // Once data went to the consumer we cannot start over on another path.
+        if (delivered > 0) {
             return result;
         }
-    } else {
-        qCWarning(ONEDRIVE) << "Download URL missing for item" << itemId << "- falling back to Graph content endpoints";
-    }
-
-    // Fallbacks: drive-scoped content, then /me/drive content
-    if (!driveId.isEmpty()) {
-        QUrl driveUrl = graphUrl(QStringLiteral("/v1.0/drives/%1/items/%2/content").arg(driveId, itemId));
-        QNetworkRequest driveReq = buildRequest(accessToken, driveUrl);
-        result = performDownload(driveReq, accessToken, onChunk, true, "drive-content");
-
-        // If we know the drive, don't fall back to /me because IDs are drive-scoped.
-        return result;
     }
 
-    QUrl url = graphUrl(QStringLiteral("/v1.0/me/drive/items/%1/content").arg(itemId));
-    QNetworkRequest bearerReq = buildRequest(accessToken, url);
-    result = performDownload(bearerReq, accessToken, onChunk, true, "me-content");
-
     return result;
 }
 
 QNetworkRequest Client::buildRequest(const QString &accessToken, const QUrl &url) const
 {
     QNetworkRequest request(url);
-    // Microsoft Graph occasionally breaks newer HTTP/2 sessions, so stick to HTTP/1.1.
-    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, false);
+    // Microsoft Graph occasionally breaks HTTP/2 sessions, hosts that did so recently are kept on HTTP/1.1.
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, isHttp2Allowed(url.host()));
     request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    request.setSslConfiguration(sslConfiguration(url.host()));
     request.setRawHeader(HeaderAuthorization, HeaderBearerPrefix + accessToken.toUtf8());
     request.setHeader(QNetworkRequest::ContentTypeHeader, MimeApplicationJson);
     return request;
@@ -470,47 +1527,6 @@ QByteArray Client::readReply(QNetworkReply *reply, ListChildrenResult &result) c
     return data;
 }
 
-DriveItem Client::parseItem(const QJsonObject &object)
-{
-    DriveItem item;
-    item.id = object.value(QStringLiteral("id")).toString();
-    item.name = object.value(QStringLiteral("name")).toString();
-    item.size = static_cast<qint64>(object.value(QStringLiteral("size")).toDouble());
-    item.lastModified = QDateTime::fromString(object.value(QStringLiteral("lastModifiedDateTime")).toString(), Qt::ISODate);
-    item.createdTime = QDateTime::fromString(object.value(QStringLiteral("createdDateTime")).toString(), Qt::ISODate);
-    item.isFolder = object.contains(QStringLiteral("folder"));
-    item.downloadUrl = object.value(QStringLiteral("@microsoft.graph.downloadUrl")).toString();
-    item.webUrl = object.value(QStringLiteral("webUrl")).toString();
-
-    if (const auto createdByObj = object.value(QStringLiteral("createdBy")).toObject(); !createdByObj.isEmpty()) {
-        const auto userObj = createdByObj.value(QStringLiteral("user")).toObject();
-        item.createdBy = userObj.value(QStringLiteral("displayName")).toString();
-    }
-    if (const auto lastModifiedByObj = object.value(QStringLiteral("lastModifiedBy")).toObject(); !lastModifiedByObj.isEmpty()) {
-        const auto userObj = lastModifiedByObj.value(QStringLiteral("user")).toObject();
-        item.lastModifiedBy = userObj.value(QStringLiteral("displayName")).toString();
-    }
-
-    const QJsonObject parent = object.value(QStringLiteral("parentReference")).toObject();
-    item.parentId = parent.value(QStringLiteral("id")).toString();
-    item.parentPath = parent.value(QStringLiteral("path")).toString();
-    item.driveId = parent.value(QStringLiteral("driveId")).toString();
-
-    if (const QJsonObject remoteItem = object.value(QStringLiteral("remoteItem")).toObject(); !remoteItem.isEmpty()) {
-        const QJsonObject remoteParent = remoteItem.value(QStringLiteral("parentReference")).toObject();
-        item.remoteDriveId = remoteParent.value(QStringLiteral("driveId")).toString();
-        item.remoteItemId = remoteItem.value(QStringLiteral("id")).toString();
-    }
-
-    if (const QJsonObject fileObj = object.value(QStringLiteral("file")).toObject(); !fileObj.isEmpty()) {
-        item.mimeType = fileObj.value(QStringLiteral("mimeType")).toString();
-    } else if (item.isFolder) {
-        item.mimeType = MimeDirectory;
-    }
-
-    return item;
-}
-
 ListChildrenResult Client::listSharedWithMe(const QString &accessToken)
 {
     if (accessToken.isEmpty()) {
@@ -524,13 +1540,7 @@ ListChildrenResult Client::listSharedWithMe(const QString &accessToken)
     query.addQueryItem(QuerySelectKey, SelectSharedWithMeFields);
     url.setQuery(query);
 
-    return fetchPagedList(accessToken, url, [](const QJsonObject &obj, ListChildrenResult &res) {
-        DriveItem item = parseItem(obj.value(QStringLiteral("remoteItem")).toObject());
-        item.remoteDriveId = item.driveId;
-        item.remoteItemId = item.id;
-        item.id = obj.value(QStringLiteral("id")).toString();
-        res.items.append(item);
-    });
+    return fetchPagedList(accessToken, url, ListItemSource::RemoteItem);
 }
 
 DrivesResult Client::listSharedDrives(const QString &accessToken)
@@ -541,9 +1551,7 @@ DrivesResult Client::listSharedDrives(const QString &accessToken)
     }
 
     QUrl url = graphUrl(QStringLiteral("/v1.0/me/drives"));
-    QNetworkReply *reply = m_network.get(buildRequest(accessToken, url));
-
-    waitForFinished(reply);
+    QNetworkReply *reply = execute(buildRequest(accessToken, url), VerbGet);
 
     if (reply->error() != QNetworkReply::NoError) {
         result.errorMessage = reply->errorString();
@@ -580,8 +1588,7 @@ QuotaResult Client::fetchDriveQuota(const QString &accessToken)
     QUrlQuery query = selectQuery(QStringLiteral("quota"));
     url.setQuery(query);
 
-    QNetworkReply *reply = m_network.get(buildRequest(accessToken, url));
-    waitForFinished(reply);
+    QNetworkReply *reply = execute(buildRequest(accessToken, url), VerbGet);
 
     if (reply->error() != QNetworkReply::NoError) {
         result.errorMessage = reply->errorString();
@@ -614,9 +1621,25 @@ ListChildrenResult Client::listDriveChildren(const QString &accessToken, const Q
     QUrlQuery query = minimalListingQuery();
     url.setQuery(query);
 
-    return fetchPagedList(accessToken, url, [](const QJsonObject &obj, ListChildrenResult &res) {
-        res.items.append(parseItem(obj));
-    });
+    return fetchPagedList(accessToken, url);
+}
+
+ListChildrenResult Client::fetchDelta(const QString &accessToken, const QString &deltaLink)
+{
+    if (accessToken.isEmpty()) {
+        return unauthorizedResult<ListChildrenResult>(ErrorMissingAccessToken);
+    }
+
+    QUrl url(deltaLink);
+    if (deltaLink.isEmpty()) {
+        // token=latest skips the initial enumeration and only returns a link for the current state.
+        url = graphUrl(QStringLiteral("/v1.0/me/drive/root/delta"));
+        QUrlQuery query = selectQuery(SelectDeltaItemFields);
+        query.addQueryItem(QStringLiteral("token"), QStringLiteral("latest"));
+        url.setQuery(query);
+    }
+
+    return fetchPagedList(accessToken, url);
 }
 
 DeleteResult Client::deleteItem(const QString &accessToken, const QString &itemId, const QString &driveId)
@@ -629,8 +1652,7 @@ DeleteResult Client::deleteItem(const QString &accessToken, const QString &itemI
     QUrl url =
         graphUrl(driveId.isEmpty() ? QStringLiteral("/v1.0/me/drive/items/%1").arg(itemId) : QStringLiteral("/v1.0/drives/%1/items/%2").arg(driveId, itemId));
 
-    QNetworkReply *reply = m_network.deleteResource(buildRequest(accessToken, url));
-    waitForFinished(reply);
+    QNetworkReply *reply = execute(buildRequest(accessToken, url), VerbDelete);
 
     if (reply->error() != QNetworkReply::NoError) {
         result.errorMessage = reply->errorString();
@@ -650,7 +1672,11 @@ static QString effectiveMimeType(const QString &mimeType)
     return mimeType.isEmpty() ? MimeOctetStream : mimeType;
 }
 
-UploadResult Client::uploadItemByPath(const QString &accessToken, const QString &relativePath, QIODevice *source, const QString &mimeType)
+UploadResult Client::uploadItemByPath(const QString &accessToken,
+                                      const QString &relativePath,
+                                      QIODevice *source,
+                                      const QString &mimeType,
+                                      const UploadProgressHandler &onProgress)
 {
     UploadResult result;
     if (accessToken.isEmpty() || relativePath.trimmed().isEmpty() || !source) {
@@ -659,19 +1685,81 @@ UploadResult Client::uploadItemByPath(const QString &accessToken, const QString
         return result;
     }
 
+    const QUrl contentUrl = graphUrl(QStringLiteral("/v1.0/me/drive/root:/%1:/content").arg(relativePath), QUrl::DecodedMode);
+    const QUrl sessionUrl = graphUrl(QStringLiteral("/v1.0/me/drive/root:/%1:/createUploadSession").arg(relativePath), QUrl::DecodedMode);
+    return uploadContent(accessToken, contentUrl, sessionUrl, source, mimeType, onProgress);
+}
+
+UploadResult Client::uploadItemById(const QString &accessToken,
+                                    const QString &driveId,
+                                    const QString &itemId,
+                                    QIODevice *source,
+                                    const QString &mimeType,
+                                    const UploadProgressHandler &onProgress)
+{
+    UploadResult result;
+    if (accessToken.isEmpty() || itemId.isEmpty() || !source) {
+        result.httpStatus = 401;
+        result.errorMessage = QStringLiteral("Missing upload information");
+        return result;
+    }
+
+    const QString itemPath =
+        driveId.isEmpty() ? QStringLiteral("/v1.0/me/drive/items/%1").arg(itemId) : QStringLiteral("/v1.0/drives/%1/items/%2").arg(driveId, itemId);
+    const QUrl contentUrl = graphUrl(itemPath + QStringLiteral("/content"));
+    const QUrl sessionUrl = graphUrl(itemPath + QStringLiteral("/createUploadSession"));
+    return uploadContent(accessToken, contentUrl, sessionUrl, source, mimeType, onProgress);
+}
+
+UploadResult Client::uploadContent(const QString &accessToken,
+                                   const QUrl &contentUrl,
+                                   const QUrl &sessionUrl,
+                                   QIODevice *source,
+                                   const QString &mimeType,
+                                   const UploadProgressHandler &onProgress)
+{
+    UploadResult result;
     if (!source->isOpen() && !source->open(QIODevice::ReadOnly)) {
         result.errorMessage = QStringLiteral("Failed to open upload source");
         return result;
     }
-    source->seek(0);
+    if (!source->isSequential()) {
+        source->seek(0);
+    }
 
-    QUrl url = graphUrl(QStringLiteral("/v1.0/me/drive/root:/%1:/content").arg(relativePath), QUrl::DecodedMode);
+    // Graph rejects simple uploads above a few MB, anything bigger goes through an upload session.
+    // Sequential sources (e.g. streamed put() data) report the announced size.
+    const qint64 totalSize = source->size();
+    if (totalSize > SimpleUploadLimit) {
+        const auto session = createUploadSession(accessToken, sessionUrl);
+        if (!session.success) {
+            result.httpStatus = session.httpStatus;
+            result.errorMessage = session.errorMessage;
+            return result;
+        }
+        // The content URL without /content addresses the item, should the session's final reply go missing.
+        QUrl itemUrl = contentUrl;
+        itemUrl.setPath(contentUrl.path().chopped(QStringLiteral("/content").size()), QUrl::DecodedMode);
+        return uploadFragments(accessToken, itemUrl, session.uploadUrl, source, totalSize, onProgress);
+    }
 
-    QNetworkRequest request = buildRequest(accessToken, url);
+    QNetworkRequest request = buildRequest(accessToken, contentUrl);
     request.setHeader(QNetworkRequest::ContentTypeHeader, effectiveMimeType(mimeType));
 
-    QNetworkReply *reply = m_network.put(request, source);
-    waitForFinished(reply);
+    // Small enough to keep in memory, which also spares QNetworkAccessManager from pulling a sequential device.
+    const QByteArray content = source->read(totalSize);
+    if (content.size() != totalSize) {
+        result.errorMessage = QStringLiteral("Upload source ended before the expected size was reached");
+        return result;
+    }
+
+    QNetworkReply *reply = execute(request, VerbPut, content, [&onProgress](QNetworkReply *attempt) {
+        if (onProgress) {
+            QObject::connect(attempt, &QNetworkReply::uploadProgress, attempt, [&onProgress](qint64 bytesSent, qint64) {
+                onProgress(bytesSent);
+            });
+        }
+    });
 
     if (reply->error() != QNetworkReply::NoError) {
         result.errorMessage = reply->errorString();
@@ -681,52 +1769,216 @@ UploadResult Client::uploadItemByPath(const QString &accessToken, const QString
     }
 
     const QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
-    result.item = parseItem(doc.object());
+    result.item = parseDriveItem(doc.object());
     result.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
     reply->deleteLater();
     result.success = true;
     return result;
 }
 
-UploadResult Client::uploadItemById(const QString &accessToken, const QString &driveId, const QString &itemId, QIODevice *source, const QString &mimeType)
+UploadSessionResult Client::createUploadSession(const QString &accessToken, const QUrl &sessionUrl)
 {
-    UploadResult result;
-    if (accessToken.isEmpty() || itemId.isEmpty() || !source) {
-        result.httpStatus = 401;
-        result.errorMessage = QStringLiteral("Missing upload information");
+    UploadSessionResult result;
+
+    QJsonObject item;
+    item.insert(QStringLiteral("@microsoft.graph.conflictBehavior"), QStringLiteral("replace"));
+    QJsonObject payload;
+    payload.insert(QStringLiteral("item"), item);
+
+    const QByteArray body = QJsonDocument(payload).toJson(QJsonDocument::Compact);
+    QNetworkReply *reply = execute(buildRequest(accessToken, sessionUrl), VerbPost, body);
+
+    result.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (reply->error() != QNetworkReply::NoError) {
+        result.errorMessage = reply->errorString();
+        const QString requestId = QString::fromUtf8(reply->rawHeader(HeaderRequestId));
+        qCWarning(ONEDRIVE) << "Graph createUploadSession failed" << sessionUrl << result.httpStatus << result.errorMessage << "requestId:" << requestId;
+        reply->deleteLater();
         return result;
     }
 
-    if (!source->isOpen() && !source->open(QIODevice::ReadOnly)) {
-        result.errorMessage = QStringLiteral("Failed to open upload source");
+    const QJsonObject session = QJsonDocument::fromJson(reply->readAll()).object();
+    reply->deleteLater();
+    result.uploadUrl = QUrl(session.value(QStringLiteral("uploadUrl")).toString());
+    if (!result.uploadUrl.isValid() || result.uploadUrl.isEmpty()) {
+        result.errorMessage = QStringLiteral("Upload session response did not contain an upload URL");
         return result;
     }
-    source->seek(0);
 
-    QUrl url = graphUrl(driveId.isEmpty() ? QStringLiteral("/v1.0/me/drive/items/%1/content").arg(itemId)
-                                          : QStringLiteral("/v1.0/drives/%1/items/%2/content").arg(driveId, itemId));
+    result.success = true;
+    return result;
+}
 
-    QNetworkRequest request = buildRequest(accessToken, url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, effectiveMimeType(mimeType));
+QNetworkRequest Client::buildFragmentRequest(const QUrl &uploadUrl, qint64 fragmentSize, qint64 offset, qint64 totalSize) const
+{
+    // The upload URL is pre-authenticated, sending the bearer token along may get the fragment rejected.
+    QNetworkRequest request = buildRequest(QString(), uploadUrl);
+    request.setRawHeader(HeaderAuthorization, QByteArray());
+    request.setHeader(QNetworkRequest::ContentTypeHeader, MimeOctetStream);
+    request.setHeader(QNetworkRequest::ContentLengthHeader, fragmentSize);
+    request.setRawHeader(HeaderContentRange, QStringLiteral("bytes %1-%2/%3").arg(offset).arg(offset + fragmentSize - 1).arg(totalSize).toLatin1());
+    // uploadFragments() retries failed fragments from where the server stopped, not the executor.
+    request.setAttribute(NoRetryAttribute, true);
+    return request;
+}
 
-    QNetworkReply *reply = m_network.put(request, source);
-    waitForFinished(reply);
+qint64 Client::queryUploadOffset(const QUrl &uploadUrl, bool *sessionGone, qint64 delayMs)
+{
+    QNetworkRequest request = buildRequest(QString(), uploadUrl);
+    request.setRawHeader(HeaderAuthorization, QByteArray());
+    QNetworkReply *reply = waitFor(startRequest(request, VerbGet, QByteArray(), {}, delayMs)->promise.future());
 
-    if (reply->error() != QNetworkReply::NoError) {
-        result.errorMessage = reply->errorString();
-        result.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
-        reply->deleteLater();
-        return result;
+    if (sessionGone) {
+        *sessionGone = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 404;
+    }
+    qint64 offset = -1;
+    if (reply->error() == QNetworkReply::NoError) {
+        // nextExpectedRanges looks like ["12345-"] or ["12345-67890"], we only care where the server wants us to resume.
+        const QJsonObject status = QJsonDocument::fromJson(reply->readAll()).object();
+        const QJsonArray ranges = status.value(QStringLiteral("nextExpectedRanges")).toArray();
+        if (!ranges.isEmpty()) {
+            bool ok = false;
+            const qint64 start = ranges.first().toString().section(QLatin1Char('-'), 0, 0).toLongLong(&ok);
+            if (ok) {
+                offset = start;
+            }
+        }
     }
+    reply->deleteLater();
+    return offset;
+}
 
-    const QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
-    result.item = parseItem(doc.object());
-    result.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+void Client::cancelUploadSession(const QUrl &uploadUrl)
+{
+    QNetworkRequest request = buildRequest(QString(), uploadUrl);
+    request.setRawHeader(HeaderAuthorization, QByteArray());
+    QNetworkReply *reply = execute(request, VerbDelete);
     reply->deleteLater();
+}
+
+UploadResult Client::fetchUploadedItem(const QString &accessToken, const QUrl &itemUrl, qint64 totalSize, const UploadResult &failure)
+{
+    QUrl url = itemUrl;
+    url.setQuery(selectQuery(SelectMinimalItemFields));
+    const DriveItemResult lookup = waitFor(fetchItemAsync(accessToken, url, false));
+    // A different size means the session ended without committing our data.
+    if (!lookup.success || lookup.item.size != totalSize) {
+        qCWarning(ONEDRIVE) << "Upload session ended without a result, the item at" << itemUrl << "has size" << lookup.item.size << "instead of" << totalSize;
+        return failure;
+    }
+
+    qCDebug(ONEDRIVE) << "Upload session finished without its final reply, found the item at" << itemUrl;
+    UploadResult result;
     result.success = true;
+    result.httpStatus = lookup.httpStatus;
+    result.item = lookup.item;
     return result;
 }
 
+UploadResult Client::uploadFragments(const QString &accessToken,
+                                     const QUrl &itemUrl,
+                                     const QUrl &uploadUrl,
+                                     QIODevice *source,
+                                     qint64 totalSize,
+                                     const UploadProgressHandler &onProgress)
+{
+    UploadResult result;
+    qint64 fragmentSize = InitialUploadFragmentSize;
+    qint64 offset = 0;
+    int attempt = 0;
+
+    QByteArray fragment = source->read(qMin(fragmentSize, totalSize));
+    QByteArray nextFragment;
+
+    while (offset < totalSize) {
+        if (fragment.isEmpty()) {
+            result.errorMessage = QStringLiteral("Upload source ended before the expected size was reached");
+            cancelUploadSession(uploadUrl);
+            return result;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        const qint64 nextOffset = offset + fragment.size();
+        const QNetworkRequest request = buildFragmentRequest(uploadUrl, fragment.size(), offset, totalSize);
+        QNetworkReply *reply = execute(request, VerbPut, fragment, [&](QNetworkReply *attempt) {
+            if (onProgress) {
+                QObject::connect(attempt, &QNetworkReply::uploadProgress, attempt, [&onProgress, offset](qint64 bytesSent, qint64) {
+                    onProgress(offset + bytesSent);
+                });
+            }
+            // Read the next fragment from the source while this one is on the wire.
+            if (nextFragment.isEmpty() && nextOffset < totalSize) {
+                nextFragment = source->read(qMin(fragmentSize, totalSize - nextOffset));
+            }
+        });
+        const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+
+        if (reply->error() != QNetworkReply::NoError) {
+            const QString errorString = reply->errorString();
+            const qint64 retryAfterMs = parseRetryAfterMs(reply->rawHeader(HeaderRetryAfter));
+            qCWarning(ONEDRIVE) << "Upload fragment" << offset << fragment.size() << "failed" << status << errorString << "attempt" << attempt + 1;
+            reply->deleteLater();
+
+            UploadResult failure;
+            failure.httpStatus = status;
+            failure.errorMessage = errorString;
+            // The session is gone once the server committed the last fragment, whose reply may be what we lost.
+            if (status == 404 && nextOffset == totalSize) {
+                return fetchUploadedItem(accessToken, itemUrl, totalSize, failure);
+            }
+            if (status == 404 || status == 410 || ++attempt >= MaxUploadFragmentAttempts) {
+                cancelUploadSession(uploadUrl);
+                return failure;
+            }
+
+            // Only resend what the server is still missing from the failed fragment. The executor waits
+            // before asking, without blocking the event loop.
+            const qint64 delayMs = retryAfterMs >= 0 ? retryAfterMs : UploadRetryDelayMs * attempt;
+            ++m_throttlingStats.retries;
+            m_throttlingStats.retryDelayMs += delayMs;
+            bool sessionGone = false;
+            const qint64 resumeOffset = queryUploadOffset(uploadUrl, &sessionGone, delayMs);
+            if ((sessionGone && nextOffset == totalSize) || resumeOffset >= totalSize) {
+                return fetchUploadedItem(accessToken, itemUrl, totalSize, failure);
+            }
+            if (resumeOffset > offset && resumeOffset < nextOffset) {
+                fragment = fragment.mid(resumeOffset - offset);
+                offset = resumeOffset;
+            } else if (resumeOffset == nextOffset) {
+                offset = nextOffset;
+                fragment = std::move(nextFragment);
+                nextFragment.clear();
+            }
+            continue;
+        }
+
+        attempt = 0;
+        fragmentSize = nextUploadFragmentSize(fragmentSize, fragment.size(), timer.elapsed());
+        offset = nextOffset;
+        if (onProgress) {
+            onProgress(offset);
+        }
+
+        if (status == 200 || status == 201) {
+            const QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
+            result.item = parseDriveItem(doc.object());
+            result.httpStatus = status;
+            reply->deleteLater();
+            result.success = true;
+            return result;
+        }
+
+        reply->deleteLater();
+        fragment = std::move(nextFragment);
+        nextFragment.clear();
+    }
+
+    result.httpStatus = 500;
+    result.errorMessage = QStringLiteral("Upload session did not return the uploaded item");
+    return fetchUploadedItem(accessToken, itemUrl, totalSize, result);
+}
+
 DriveItemResult Client::updateItem(const QString &accessToken, const QString &driveId, const QString &itemId, const QString &newName, const QString &parentPath)
 {
     DriveItemResult result;
@@ -756,9 +2008,7 @@ DriveItemResult Client::updateItem(const QString &accessToken, const QString &dr
 
     QNetworkRequest request = buildRequest(accessToken, url);
     const QByteArray body = QJsonDocument(payload).toJson(QJsonDocument::Compact);
-    QNetworkReply *reply = m_network.sendCustomRequest(request, "PATCH", body);
-
-    waitForFinished(reply);
+    QNetworkReply *reply = execute(request, VerbPatch, body);
 
     if (reply->error() != QNetworkReply::NoError) {
         result.errorMessage = reply->errorString();
@@ -768,7 +2018,7 @@ DriveItemResult Client::updateItem(const QString &accessToken, const QString &dr
     }
 
     const QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
-    result.item = parseItem(doc.object());
+    result.item = parseDriveItem(doc.object());
     result.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
     reply->deleteLater();
     result.success = true;
@@ -792,9 +2042,7 @@ DriveItemResult Client::createFolder(const QString &accessToken, const QString &
 
     QNetworkRequest request = buildRequest(accessToken, url);
     const QByteArray body = QJsonDocument(payload).toJson(QJsonDocument::Compact);
-    QNetworkReply *reply = m_network.post(request, body);
-
-    waitForFinished(reply);
+    QNetworkReply *reply = execute(request, VerbPost, body);
 
     if (reply->error() != QNetworkReply::NoError) {
         result.errorMessage = reply->errorString();
@@ -804,7 +2052,7 @@ DriveItemResult Client::createFolder(const QString &accessToken, const QString &
     }
 
     const QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
-    result.item = parseItem(doc.object());
+    result.item = parseDriveItem(doc.object());
     result.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
     reply->deleteLater();
     result.success = true;
@@ -816,7 +2064,8 @@ DriveItemResult Client::copyItem(const QString &accessToken,
                                  const QString &itemId,
                                  const QString &newName,
                                  const QString &parentPath,
-                                 const QString &destinationPath)
+                                 const QString &destinationPath,
+                                 const CopyProgressHandler &onProgress)
 {
     DriveItemResult result;
     if (accessToken.isEmpty() || itemId.isEmpty() || parentPath.isEmpty()) {
@@ -836,8 +2085,7 @@ DriveItemResult Client::copyItem(const QString &accessToken,
 
     const QByteArray body = QJsonDocument(payload).toJson(QJsonDocument::Compact);
     qCDebug(ONEDRIVE) << "Graph copy POST" << url << body;
-    QNetworkReply *reply = m_network.post(buildRequest(accessToken, url), body);
-    waitForFinished(reply);
+    QNetworkReply *reply = execute(buildRequest(accessToken, url), VerbPost, body);
 
     if (reply->error() != QNetworkReply::NoError) {
         result.errorMessage = reply->errorString();
@@ -853,7 +2101,7 @@ DriveItemResult Client::copyItem(const QString &accessToken,
 
     if (status == 200 || status == 201) {
         if (!immediateData.isEmpty()) {
-            result.item = parseItem(QJsonDocument::fromJson(immediateData).object());
+            result.item = parseDriveItem(QJsonDocument::fromJson(immediateData).object());
         }
         result.httpStatus = status;
         result.success = true;
@@ -881,10 +2129,9 @@ DriveItemResult Client::copyItem(const QString &accessToken,
         if (!targetId.isEmpty()) {
             finalResult = getItemById(accessToken, QString(), targetId);
         } else if (!resourceLocation.isEmpty()) {
-            QNetworkReply *resourceReply = m_network.get(buildRequest(accessToken, QUrl(resourceLocation)));
-            waitForFinished(resourceReply);
+            QNetworkReply *resourceReply = execute(buildRequest(accessToken, QUrl(resourceLocation)), VerbGet);
             if (resourceReply->error() == QNetworkReply::NoError) {
-                finalResult.item = parseItem(QJsonDocument::fromJson(resourceReply->readAll()).object());
+                finalResult.item = parseDriveItem(QJsonDocument::fromJson(resourceReply->readAll()).object());
                 finalResult.httpStatus = resourceReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
                 finalResult.success = true;
             } else {
@@ -900,14 +2147,22 @@ DriveItemResult Client::copyItem(const QString &accessToken,
         return finalResult;
     };
 
-    QElapsedTimer timer;
-    timer.start();
+    QDeadlineTimer stallDeadline(CopyMonitorStallTimeoutMs);
+    qint64 delayMs = InitialCopyMonitorDelayMs;
+    qint64 nextPollDelayMs = 0;
+    double lastPercentage = -1;
+    // The executor sends the next poll from a timer, the event loop keeps running meanwhile.
+    auto delayNextPoll = [&delayMs, &nextPollDelayMs]() {
+        nextPollDelayMs = delayMs;
+        delayMs = std::min(delayMs * 3 / 2, MaxCopyMonitorDelayMs);
+    };
 
-    while (timer.elapsed() < CopyMonitorTimeoutMs) {
-        QNetworkRequest monitorRequest = buildRequest(accessToken, QUrl(monitorUrl));
+    while (!stallDeadline.hasExpired()) {
+        // The monitor URL is pre-authenticated and may answer 401 to requests that carry a token.
+        QNetworkRequest monitorRequest = buildRequest(QString(), QUrl(monitorUrl));
+        monitorRequest.setRawHeader(HeaderAuthorization, QByteArray());
         monitorRequest.setRawHeader(HeaderAccept, MimeApplicationJson.toUtf8());
-        QNetworkReply *monitorReply = m_network.get(monitorRequest);
-        waitForFinished(monitorReply);
+        QNetworkReply *monitorReply = waitFor(startRequest(monitorRequest, VerbGet, QByteArray(), {}, std::exchange(nextPollDelayMs, 0))->promise.future());
 
         const int httpStatus = monitorReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
         const QByteArray monitorData = monitorReply->readAll();
@@ -928,7 +2183,7 @@ DriveItemResult Client::copyItem(const QString &accessToken,
                 const QString requestId = QString::fromUtf8(monitorReply->rawHeader(HeaderRequestId));
                 qCDebug(ONEDRIVE) << "Graph copy monitor returned 401, retrying" << requestId;
                 monitorReply->deleteLater();
-                QThread::msleep(CopyMonitorDelayMs);
+                delayNextPoll();
                 continue;
             }
             result.errorMessage = monitorReply->errorString();
@@ -961,10 +2216,167 @@ DriveItemResult Client::copyItem(const QString &accessToken,
             return result;
         }
 
-        QThread::msleep(CopyMonitorDelayMs);
+        const double percentage = monitorObj.value(QStringLiteral("percentageComplete")).toDouble(-1);
+        if (percentage > lastPercentage) {
+            lastPercentage = percentage;
+            stallDeadline.setRemainingTime(CopyMonitorStallTimeoutMs);
+            if (onProgress) {
+                onProgress(percentage);
+            }
+        }
+
+        delayNextPoll();
     }
 
     result.httpStatus = 504;
-    result.errorMessage = QStringLiteral("Timed out waiting for copy operation");
+    result.errorMessage = QStringLiteral("Copy operation stopped making progress");
+    return result;
+}
+
+BatchResult Client::executeBatch(const QString &accessToken, const QList<BatchRequest> &requests)
+{
+    BatchResult result;
+    if (accessToken.isEmpty()) {
+        return unauthorizedResult<BatchResult>(ErrorMissingAccessToken);
+    }
+
+    BatchPlan plan(requests);
+    if (!plan.error().isEmpty()) {
+        result.httpStatus = 400;
+        result.errorMessage = plan.error();
+        return result;
+    }
+
+    qint64 throttledWaitMs = 0;
+    qint64 delayMs = 0;
+    while (plan.hasPending()) {
+        const QByteArray body = plan.nextPayload();
+        if (body.isEmpty()) {
+            continue;
+        }
+
+        // Throttled sub-requests wait on the executor's timer like a throttled request does, the event loop keeps running.
+        const auto pending = startRequest(buildRequest(accessToken, graphUrl(QStringLiteral("/v1.0/$batch"))), VerbPost, body, {}, std::exchange(delayMs, 0));
+        QNetworkReply *reply = waitFor(pending->promise.future());
+
+        result.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (reply->error() != QNetworkReply::NoError) {
+            result.errorMessage = reply->errorString();
+            const QString requestId = QString::fromUtf8(reply->rawHeader(HeaderRequestId));
+            qCWarning(ONEDRIVE) << "Graph $batch failed" << result.httpStatus << result.errorMessage << "requestId:" << requestId;
+            reply->deleteLater();
+            return result;
+        }
+
+        delayMs = plan.applyReply(reply->readAll());
+        reply->deleteLater();
+        if (delayMs > 0) {
+            ++m_throttlingStats.throttledReplies;
+            // Same budget as a single throttled request, what is still throttled after it keeps its 429.
+            // Requests that haven't been sent yet still get their chance.
+            if (throttledWaitMs + delayMs > MaxRetryBudgetMs) {
+                ++m_throttlingStats.exhaustedRetries;
+                qCWarning(ONEDRIVE) << "Giving up on throttled $batch requests after waiting" << throttledWaitMs << "ms";
+                plan.dropThrottled();
+                delayMs = 0;
+                continue;
+            }
+            qCDebug(ONEDRIVE) << "$batch requests throttled, sending them again in" << delayMs << "ms";
+            ++m_throttlingStats.retries;
+            m_throttlingStats.retryDelayMs += delayMs;
+            throttledWaitMs += delayMs;
+        }
+    }
+
+    result.responses = plan.responses();
+    result.success = true;
     return result;
 }
+
+QList<DriveItemResult> Client::getItemsById(const QString &accessToken, const QList<ItemReference> &items)
+{
+    const QString query = selectQuery(SelectMinimalItemFields).toString(QUrl::FullyEncoded);
+    QList<BatchRequest> requests;
+    for (qsizetype i = 0; i < items.size(); ++i) {
+        requests.append(BatchRequest{QString::number(i), VerbGet, itemResourcePath(items.at(i)) + QLatin1Char('?') + query, {}, {}});
+    }
+
+    const auto batch = executeBatch(accessToken, requests);
+    QList<DriveItemResult> results;
+    for (qsizetype i = 0; i < items.size(); ++i) {
+        DriveItemResult itemResult;
+        if (!batch.success) {
+            itemResult.httpStatus = batch.httpStatus;
+            itemResult.errorMessage = batch.errorMessage;
+        } else if (const BatchResponse &response = batch.responses.at(i); !isSuccessStatus(response.httpStatus)) {
+            itemResult.httpStatus = response.httpStatus;
+            itemResult.errorMessage = batchErrorMessage(response);
+        } else {
+            itemResult.httpStatus = response.httpStatus;
+            itemResult.item = parseDriveItem(response.body);
+            itemResult.success = true;
+        }
+        results.append(itemResult);
+    }
+    return results;
+}
+
+QList<DeleteResult> Client::deleteItems(const QString &accessToken, const QList<ItemReference> &items)
+{
+    QList<BatchRequest> requests;
+    for (qsizetype i = 0; i < items.size(); ++i) {
+        requests.append(BatchRequest{QString::number(i), VerbDelete, itemResourcePath(items.at(i)), {}, {}});
+    }
+
+    const auto batch = executeBatch(accessToken, requests);
+    QList<DeleteResult> results;
+    for (qsizetype i = 0; i < items.size(); ++i) {
+        DeleteResult deleteResult;
+        if (!batch.success) {
+            deleteResult.httpStatus = batch.httpStatus;
+            deleteResult.errorMessage = batch.errorMessage;
+        } else {
+            const BatchResponse &response = batch.responses.at(i);
+            deleteResult.httpStatus = response.httpStatus;
+            deleteResult.success = isSuccessStatus(response.httpStatus);
+            if (!deleteResult.success) {
+                deleteResult.errorMessage = batchErrorMessage(response);
+            }
+        }
+        results.append(deleteResult);
+    }
+    return results;
+}
+
+QList<DriveItemResult> Client::moveItems(const QString &accessToken, const QList<ItemReference> &items, const QString &parentPath)
+{
+    QJsonObject parentRef;
+    parentRef.insert(QStringLiteral("path"), parentPath);
+    QJsonObject payload;
+    payload.insert(QStringLiteral("parentReference"), parentRef);
+
+    const QString query = selectQuery(SelectMinimalItemFields).toString(QUrl::FullyEncoded);
+    QList<BatchRequest> requests;
+    for (qsizetype i = 0; i < items.size(); ++i) {
+        requests.append(BatchRequest{QString::number(i), VerbPatch, itemResourcePath(items.at(i)) + QLatin1Char('?') + query, payload, {}});
+    }
+
+    const auto batch = executeBatch(accessToken, requests);
+    QList<DriveItemResult> results;
+    for (qsizetype i = 0; i < items.size(); ++i) {
+        DriveItemResult itemResult;
+        if (!batch.success) {
+            itemResult.httpStatus = batch.httpStatus;
+            itemResult.errorMessage = batch.errorMessage;
+        } else if (const BatchResponse &response = batch.responses.at(i); !isSuccessStatus(response.httpStatus)) {
+            itemResult.httpStatus = response.httpStatus;
+            itemResult.errorMessage = batchErrorMessage(response);
+        } else {
+            itemResult.httpStatus = response.httpStatus;
+            itemResult.item = parseDriveItem(response.body);
+            itemResult.success = true;
+        }
+        results.append(itemResult);
+    }
+    return results;
+}
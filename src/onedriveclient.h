@@ -7,12 +7,31 @@
 
 #pragma once
 
+#include "bufferpool.h"
+#include "graphbatch.h"
+#include "graphjson.h"
+#include "hosthistory.h"
+#include "tlssessionstore.h"
+
+#include <QCache>
 #include <QDateTime>
+#include <QDeadlineTimer>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFlags>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QHash>
 #include <QJsonObject>
 #include <QList>
 #include <QNetworkAccessManager>
 #include <QObject>
+#include <QPointer>
+#include <QSslConfiguration>
+#include <QStringList>
+#include <QUrl>
 #include <functional>
+#include <memory>
 
 class QIODevice;
 
@@ -20,30 +39,25 @@ class QNetworkReply;
 
 namespace OneDrive
 {
-struct DriveItem {
-    QString id;
-    QString name;
-    QString parentId;
-    QString parentPath;
-    QString driveId;
-    QString remoteDriveId;
-    QString remoteItemId;
-    QString mimeType;
-    QString downloadUrl;
-    QString webUrl;
-    QString createdBy;
-    QString lastModifiedBy;
-    QDateTime createdTime;
-    bool isFolder = false;
-    qint64 size = 0;
-    QDateTime lastModified;
+/**
+ * driveItem properties that a listing or lookup may leave out. id, name, size, parentReference,
+ * folder and file are always requested.
+ */
+enum class ItemField {
+    NoExtraFields = 0x0,
+    Times = 0x1, ///< createdDateTime and lastModifiedDateTime
+    People = 0x2, ///< createdBy and lastModifiedBy
+    Links = 0x4, ///< webUrl and the pre-authenticated download URL
+    AllFields = Times | People | Links,
 };
+Q_DECLARE_FLAGS(ItemFields, ItemField)
 
 struct ListChildrenResult {
     bool success = false;
     int httpStatus = 0;
     QString errorMessage;
     QString nextLink;
+    QString deltaLink;
     QList<DriveItem> items;
 };
 
@@ -52,6 +66,10 @@ struct DriveItemResult {
     int httpStatus = 0;
     QString errorMessage;
     DriveItem item;
+    // Only set when the children were expanded: the first page of them, and where the rest continues.
+    bool childrenExpanded = false;
+    QList<DriveItem> children;
+    QString childrenNextLink;
 };
 
 struct DownloadResult {
@@ -80,6 +98,32 @@ struct UploadResult {
     DriveItem item;
 };
 
+struct UploadSessionResult {
+    bool success = false;
+    int httpStatus = 0;
+    QString errorMessage;
+    QUrl uploadUrl;
+};
+
+struct ItemReference {
+    QString driveId;
+    QString itemId;
+};
+
+struct BatchResult {
+    bool success = false;
+    int httpStatus = 0;
+    QString errorMessage;
+    QList<BatchResponse> responses;
+};
+
+using UploadProgressHandler = std::function<void(qint64 uploadedBytes)>;
+using CopyProgressHandler = std::function<void(double percentageComplete)>;
+/**
+ * Receives the items of a listing one page at a time, in order. Returning false stops the listing.
+ */
+using ListPageHandler = std::function<bool(const QList<DriveItem> &items)>;
+
 struct DriveInfo {
     QString id;
     QString name;
@@ -100,33 +144,127 @@ struct DrivesResult {
     QList<DriveInfo> drives;
 };
 
+struct ProtocolStats {
+    quint64 http1Replies = 0;
+    quint64 http2Replies = 0;
+    quint64 http2Fallbacks = 0;
+    // Time from sending the first request to its reply, -1 until then.
+    qint64 firstRequestMs = -1;
+    bool firstRequestOfferedTlsTicket = false;
+    quint64 stalledReplies = 0;
+    quint64 hedgedRequests = 0;
+    quint64 hedgesWon = 0;
+    // Item lookups answered with 304 Not Modified from the eTag of an earlier reply.
+    quint64 notModifiedReplies = 0;
+};
+
+struct ThrottlingStats {
+    quint64 throttledReplies = 0;
+    quint64 retries = 0;
+    quint64 exhaustedRetries = 0;
+    qint64 retryDelayMs = 0;
+    quint64 pacedRequests = 0;
+    qint64 pacingDelayMs = 0;
+};
+
 class Client : public QObject
 {
     Q_OBJECT
 public:
+    // A single TCP stream to the storage hosts rarely fills a high-latency link, so downloads of at
+    // least this many bytes are split in ranges fetched in parallel.
+    static constexpr qint64 RangedDownloadThreshold = 64 * 1024 * 1024;
+
     explicit Client(QObject *parent = nullptr);
 
-    [[nodiscard]] ListChildrenResult listChildren(const QString &accessToken, const QString &driveId = QString(), const QString &itemId = QString());
-    [[nodiscard]] ListChildrenResult listChildrenByPath(const QString &accessToken, const QString &relativePath);
-    [[nodiscard]] DriveItemResult getItemByPath(const QString &accessToken, const QString &relativePath);
+    /**
+     * Lists the children of a folder. With an @p onPage handler, items are handed over as each page
+     * arrives instead of being collected in ListChildrenResult::items; the listing fails with
+     * "Listing aborted" if the handler stops it.
+     */
+    [[nodiscard]] ListChildrenResult listChildren(const QString &accessToken,
+                                                  const QString &driveId = QString(),
+                                                  const QString &itemId = QString(),
+                                                  const ListPageHandler &onPage = ListPageHandler(),
+                                                  ItemFields fields = ItemField::AllFields);
+    [[nodiscard]] ListChildrenResult listChildrenByPath(const QString &accessToken,
+                                                        const QString &relativePath,
+                                                        const ListPageHandler &onPage = ListPageHandler(),
+                                                        ItemFields fields = ItemField::AllFields);
+    /**
+     * Continues a listing at @p nextLink, e.g. DriveItemResult::childrenNextLink.
+     */
+    [[nodiscard]] ListChildrenResult continueListing(const QString &accessToken, const QString &nextLink, const ListPageHandler &onPage = ListPageHandler());
+    /**
+     * @param expandChildren Also fetch the first page of children if the item is a folder, which
+     * saves the round trip of a listing that is about to follow. Children always come with all fields,
+     * as the listing may ask for more than @p fields.
+     */
+    [[nodiscard]] DriveItemResult
+    getItemByPath(const QString &accessToken, const QString &relativePath, bool expandChildren = false, ItemFields fields = ItemField::AllFields);
     [[nodiscard]] DriveItemResult getItemById(const QString &accessToken, const QString &driveId, const QString &itemId);
+
+    /**
+     * Asynchronous variants of the item lookups. The request is sent right away, so several
+     * of them can be in flight at once; results are delivered in the thread of this Client.
+     */
+    [[nodiscard]] QFuture<DriveItemResult>
+    getItemByPathAsync(const QString &accessToken, const QString &relativePath, bool expandChildren = false, ItemFields fields = ItemField::AllFields);
+    [[nodiscard]] QFuture<DriveItemResult> getItemByIdAsync(const QString &accessToken, const QString &driveId, const QString &itemId);
+    [[nodiscard]] QFuture<DriveItemResult>
+    getDriveItemByPathAsync(const QString &accessToken, const QString &driveId, const QString &itemId, const QString &relativePath);
+
+    /**
+     * Runs a local event loop until @p future is finished, for callers that are synchronous themselves.
+     */
+    template<typename T>
+    static T waitFor(const QFuture<T> &future)
+    {
+        if (!future.isFinished()) {
+            QEventLoop loop;
+            QFutureWatcher<T> watcher;
+            QObject::connect(&watcher, &QFutureWatcher<T>::finished, &loop, &QEventLoop::quit);
+            watcher.setFuture(future);
+            loop.exec();
+        }
+        return future.result();
+    }
     [[nodiscard]] DownloadResult
     downloadItem(const QString &accessToken, const QString &itemId, const QString &downloadUrl = QString(), const QString &driveId = QString());
+    /**
+     * Streams the content of @p itemId to @p onChunk, in order.
+     * Items of at least RangedDownloadThreshold bytes (per @p itemSize) are fetched over several
+     * connections using byte ranges of the signed download URL; pass 0 if the size is unknown.
+     */
     [[nodiscard]] DownloadStreamResult streamDownloadItem(const QString &accessToken,
                                                           const QString &itemId,
                                                           const QString &downloadUrl,
                                                           const QString &driveId,
+                                                          qint64 itemSize,
                                                           const std::function<bool(const QByteArray &)> &onChunk);
     [[nodiscard]] ListChildrenResult listSharedWithMe(const QString &accessToken);
     [[nodiscard]] DrivesResult listSharedDrives(const QString &accessToken);
     [[nodiscard]] DriveItemResult getDriveItemByPath(const QString &accessToken, const QString &driveId, const QString &itemId, const QString &relativePath);
     [[nodiscard]] QuotaResult fetchDriveQuota(const QString &accessToken);
     [[nodiscard]] ListChildrenResult listDriveChildren(const QString &accessToken, const QString &driveId, const QString &itemId = QString());
+    /**
+     * Fetches the changes of the personal drive since @p deltaLink, see DriveItem::deleted for removals.
+     * Without a @p deltaLink, only a link for the current state of the drive is fetched.
+     * The link to use next time is returned in ListChildrenResult::deltaLink.
+     */
+    [[nodiscard]] ListChildrenResult fetchDelta(const QString &accessToken, const QString &deltaLink = QString());
     [[nodiscard]] DeleteResult deleteItem(const QString &accessToken, const QString &itemId, const QString &driveId = QString());
-    [[nodiscard]] UploadResult
-    uploadItemByPath(const QString &accessToken, const QString &relativePath, QIODevice *source, const QString &mimeType = QString());
-    [[nodiscard]] UploadResult
-    uploadItemById(const QString &accessToken, const QString &driveId, const QString &itemId, QIODevice *source, const QString &mimeType = QString());
+    [[nodiscard]] UploadResult uploadItemByPath(const QString &accessToken,
+                                                const QString &relativePath,
+                                                QIODevice *source,
+                                                const QString &mimeType = QString(),
+                                                const UploadProgressHandler &onProgress = UploadProgressHandler());
+    [[nodiscard]] UploadResult uploadItemById(const QString &accessToken,
+                                              const QString &driveId,
+                                              const QString &itemId,
+                                              QIODevice *source,
+                                              const QString &mimeType = QString(),
+                                              const UploadProgressHandler &onProgress = UploadProgressHandler());
     [[nodiscard]] DriveItemResult
     updateItem(const QString &accessToken, const QString &driveId, const QString &itemId, const QString &newName, const QString &parentPath = QString());
     [[nodiscard]] DriveItemResult createFolder(const QString &accessToken, const QString &driveId, const QString &parentId, const QString &name);
@@ -135,19 +273,198 @@ public:
                                            const QString &itemId,
                                            const QString &newName,
                                            const QString &parentPath,
-                                           const QString &destinationPath);
+                                           const QString &destinationPath,
+                                           const CopyProgressHandler &onProgress = CopyProgressHandler());
+
+    /**
+     * Sends @p requests through POST /$batch, packing up to BatchPlan::MaxBatchSize sub-requests per round trip.
+     * Requests are ordered by their dependsOn relations; a request whose dependency ended up in an
+     * earlier round trip and failed gets a 424 response without being sent. Throttled sub-requests
+     * are sent again after their Retry-After, within the retry budget of a single request.
+     * @return One response per request, in the order of @p requests.
+     */
+    [[nodiscard]] BatchResult executeBatch(const QString &accessToken, const QList<BatchRequest> &requests);
+    [[nodiscard]] QList<DriveItemResult> getItemsById(const QString &accessToken, const QList<ItemReference> &items);
+    [[nodiscard]] QList<DeleteResult> deleteItems(const QString &accessToken, const QList<ItemReference> &items);
+    [[nodiscard]] QList<DriveItemResult> moveItems(const QString &accessToken, const QList<ItemReference> &items, const QString &parentPath);
+
+    /**
+     * Starts DNS, TCP and TLS setup to Graph and to the storage hosts of recent downloads,
+     * so that the first requests find a ready connection.
+     */
+    void warmUp();
+
+    /**
+     * @return How many replies used HTTP/1.1 or HTTP/2, how often a host was put back on
+     * HTTP/1.1 after an HTTP/2 failure, how many transfers were aborted because they stalled,
+     * and how many metadata requests were hedged and answered by the hedge first.
+     */
+    [[nodiscard]] ProtocolStats protocolStats() const;
+    /**
+     * @return How many 429/503 replies were received, how many requests were retried and
+     * for how long in total, how often a request failed after exhausting its retries, and
+     * how many requests were held back to stay within the advertised rate limit.
+     */
+    [[nodiscard]] ThrottlingStats throttlingStats() const;
+
+    /**
+     * Called with the rejected token when Graph answers a request with 401. Should return a
+     * fresh access token, or an empty string if there is none.
+     */
+    using TokenRefresher = std::function<QString(const QString &staleToken)>;
+    /**
+     * Makes requests rejected with 401 repeat once with the token returned by @p refresher.
+     */
+    void setTokenRefresher(const TokenRefresher &refresher);
+
+    /**
+     * Lets requests negotiate HTTP/2, off by default. Hosts whose HTTP/2 sessions break are
+     * still kept on HTTP/1.1 for a while.
+     */
+    void setHttp2Enabled(bool enabled);
 
 private:
     QNetworkAccessManager m_network;
+    // Graph used to break HTTP/2 sessions often enough that it stays opt-in.
+    bool m_http2Enabled = false;
+    QHash<QString /* host */, QDeadlineTimer> m_http2Cooldowns;
+    ProtocolStats m_protocolStats;
+    ThrottlingStats m_throttlingStats;
+    BufferPool m_bufferPool;
+    qint64 m_downloadChunkSize;
+    TokenRefresher m_tokenRefresher;
+    HostHistory m_downloadHosts;
+    TlsSessionStore m_tlsSessions;
+    QElapsedTimer m_firstRequestTimer;
+    QList<qint64> m_metadataLatencies;
+
+    struct CachedItemReply {
+        DriveItemResult result;
+        QDeadlineTimer expiry;
+    };
+    QCache<QString /* request URL */, CachedItemReply> m_itemReplies;
+
+    enum class DownloadStrategy {
+        SignedUrl,
+        DriveContent,
+        MeContent,
+    };
+    // The download strategy that worked last, by drive ID ("me" for the user's own drive).
+    QHash<QString, DownloadStrategy> m_downloadStrategies;
+    QHash<QString /* stale token */, QString> m_refreshedTokens;
+
+    // Resource units left in the current rate limit window, as advertised by the RateLimit-* headers.
+    struct RateLimitBucket {
+        double tokens = 0;
+        double capacity = 0;
+        double refillPerMs = 0;
+        QElapsedTimer lastRefill;
+        QDeadlineTimer resetDeadline;
+    };
+    QHash<QString /* host and account */, RateLimitBucket> m_rateLimits;
+
+    [[nodiscard]] bool isHttp2Allowed(const QString &host) const;
+    void recordReplyProtocol(QNetworkReply *reply);
+    void rememberTlsSession(QNetworkReply *reply);
+    [[nodiscard]] QSslConfiguration sslConfiguration(const QString &host) const;
+    [[nodiscard]] qint64 reservePacing(const QString &rateLimitKey, double cost);
+    void updateRateLimit(const QString &rateLimitKey, const QNetworkReply *reply);
 
     [[nodiscard]] QNetworkRequest buildRequest(const QString &accessToken, const QUrl &url) const;
+    struct PendingRequest;
+    /**
+     * sendAsync() that hands out the request, for cancelRequest(). The first attempt waits @p delayMs
+     * on a timer, like a retry does.
+     */
+    [[nodiscard]] std::shared_ptr<PendingRequest> startRequest(const QNetworkRequest &request,
+                                                              const QByteArray &verb,
+                                                              const QByteArray &body = QByteArray(),
+                                                              const std::function<void(QNetworkReply *)> &onStarted = std::function<void(QNetworkReply *)>(),
+                                                              qint64 delayMs = 0);
+    /**
+     * Gives up on @p pending: a waiting attempt is not sent, one in flight is aborted, and its
+     * future is canceled without a reply.
+     */
+    void cancelRequest(const std::shared_ptr<PendingRequest> &pending);
+    void scheduleAttempt(const std::shared_ptr<PendingRequest> &pending);
+    void waitBeforeAttempt(const std::shared_ptr<PendingRequest> &pending, qint64 delayMs, void (Client::*attempt)(const std::shared_ptr<PendingRequest> &));
+    void sendAttempt(const std::shared_ptr<PendingRequest> &pending);
+    void finishAttempt(const std::shared_ptr<PendingRequest> &pending, QNetworkReply *reply);
+    [[nodiscard]] bool retryWithFreshToken(const std::shared_ptr<PendingRequest> &pending);
+    void recordMetadataLatency(qint64 latencyMs);
+    [[nodiscard]] qint64 hedgeDelayMs(const QNetworkRequest &request) const;
+
+    /**
+     * Sends @p request. Throttled replies (429, 503) are retried after the delay asked for in
+     * Retry-After, or after a jittered exponential backoff if there is none; idempotent requests
+     * are also retried on transient network errors. Retries stop once MaxRequestAttempts or the
+     * MaxRetryBudgetMs of waiting is reached. Waits between attempts never block the event loop.
+     * @p onStarted is called with every attempt's reply right after it was sent.
+     * @return The finished reply of the last attempt, to be deleted by the caller.
+     */
+    [[nodiscard]] QFuture<QNetworkReply *> sendAsync(const QNetworkRequest &request,
+                                                     const QByteArray &verb,
+                                                     const QByteArray &body = QByteArray(),
+                                                     const std::function<void(QNetworkReply *)> &onStarted = std::function<void(QNetworkReply *)>());
+    /**
+     * sendAsync() for idempotent metadata GETs. Once enough replies were timed, a second copy of
+     * @p request is sent if the first got no answer within the 95th percentile of their latencies.
+     * The first reply wins and the other request is aborted.
+     */
+    [[nodiscard]] QFuture<QNetworkReply *> sendHedgedAsync(const QNetworkRequest &request);
+    /**
+     * Looks up the driveItem at @p url with sendHedgedAsync(). With @p revalidate, a repeated lookup
+     * sends the eTag of the cached reply in If-None-Match and a 304 Not Modified is answered from the cache.
+     * Failures are logged under @p label, if given.
+     */
+    [[nodiscard]] QFuture<DriveItemResult> fetchItemAsync(const QString &accessToken, const QUrl &url, bool revalidate, const char *label = nullptr);
+    /**
+     * Synchronous sendAsync().
+     */
+    [[nodiscard]] QNetworkReply *execute(const QNetworkRequest &request,
+                                         const QByteArray &verb,
+                                         const QByteArray &body = QByteArray(),
+                                         const std::function<void(QNetworkReply *)> &onStarted = std::function<void(QNetworkReply *)>());
     [[nodiscard]] QByteArray readReply(QNetworkReply *reply, ListChildrenResult &result) const;
-    [[nodiscard]] static DriveItem parseItem(const QJsonObject &object);
+    [[nodiscard]] static DriveItemResult readItemReply(QNetworkReply *reply);
     [[nodiscard]] DownloadStreamResult
     performDownload(QNetworkRequest req, const QString &accessToken, const std::function<bool(const QByteArray &)> &onChunk, bool withAuth, const char *label);
-    [[nodiscard]] ListChildrenResult
-    fetchPagedList(const QString &accessToken, const QUrl &url, const std::function<void(const QJsonObject &, ListChildrenResult &)> &append);
-    void
-    parseListPayload(const QByteArray &payload, ListChildrenResult &res, const std::function<void(const QJsonObject &, ListChildrenResult &)> &append) const;
+    [[nodiscard]] DownloadStreamResult performRangedDownload(const QUrl &url, qint64 totalSize, const std::function<bool(const QByteArray &)> &onChunk);
+    /**
+     * Follows @odata.nextLink from @p url and collects the items of all pages, taking each from @p source,
+     * or hands them to @p onPage as they arrive.
+     */
+    [[nodiscard]] ListChildrenResult fetchPagedList(const QString &accessToken,
+                                                    const QUrl &url,
+                                                    ListItemSource source = ListItemSource::Item,
+                                                    const ListPageHandler &onPage = ListPageHandler());
+    [[nodiscard]] UploadResult uploadContent(const QString &accessToken,
+                                             const QUrl &contentUrl,
+                                             const QUrl &sessionUrl,
+                                             QIODevice *source,
+                                             const QString &mimeType,
+                                             const UploadProgressHandler &onProgress);
+    [[nodiscard]] UploadSessionResult createUploadSession(const QString &accessToken, const QUrl &sessionUrl);
+    [[nodiscard]] UploadResult uploadFragments(const QString &accessToken,
+                                               const QUrl &itemUrl,
+                                               const QUrl &uploadUrl,
+                                               QIODevice *source,
+                                               qint64 totalSize,
+                                               const UploadProgressHandler &onProgress);
+    /**
+     * Looks up the item at @p itemUrl after an upload session ended without returning it.
+     * @return The item if it has @p totalSize bytes, @p failure otherwise.
+     */
+    [[nodiscard]] UploadResult fetchUploadedItem(const QString &accessToken, const QUrl &itemUrl, qint64 totalSize, const UploadResult &failure);
+    [[nodiscard]] QNetworkRequest buildFragmentRequest(const QUrl &uploadUrl, qint64 fragmentSize, qint64 offset, qint64 totalSize) const;
+    /**
+     * @return Where the upload session wants the next fragment to start, or -1 if unknown.
+     * @p sessionGone is set if the session no longer exists, e.g. because it completed.
+     * The session is asked after waiting @p delayMs.
+     */
+    [[nodiscard]] qint64 queryUploadOffset(const QUrl &uploadUrl, bool *sessionGone = nullptr, qint64 delayMs = 0);
+    void cancelUploadSession(const QUrl &uploadUrl);
 };
 }
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(OneDrive::ItemFields)
@@ -9,6 +9,7 @@
 #include "onedrivedebug.h"
 
 #include <QDateTime>
+#include <QSet>
 
 PathCache::PathCache()
 {
@@ -67,6 +68,27 @@ void PathCache::removePath(const QString &path)
     }
 }
 
+QStringList PathCache::removeIds(const QStringList &fileIds)
+{
+    const QSet<QString> ids(fileIds.cbegin(), fileIds.cend());
+
+    QStringList paths;
+    for (auto iter = m_pathIdMap.cbegin(); iter != m_pathIdMap.cend(); ++iter) {
+        if (ids.contains(iter.value())) {
+            paths.append(iter.key());
+        }
+    }
+
+    for (const QString &path : std::as_const(paths)) {
+        const QString prefix = path + QLatin1Char('/');
+        m_pathIdMap.removeIf([&](const auto &entry) {
+            return entry.key() == path || entry.key().startsWith(prefix);
+        });
+    }
+
+    return paths;
+}
+
 void PathCache::dump()
 {
     qCDebug(ONEDRIVE) << "==== DUMP ====";
@@ -23,6 +23,12 @@ public:
     QStringList descendants(const QString &path) const;
     void removePath(const QString &path);
 
+    /**
+     * Forgets the paths that lead to any of @p fileIds and everything below them.
+     * @return The forgotten paths that led to @p fileIds.
+     */
+    QStringList removeIds(const QStringList &fileIds);
+
     void dump();
 
 private:
@@ -0,0 +1,108 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "putdatadevice.h"
+#include "onedrivedebug.h"
+
+#include <KIO/WorkerBase>
+
+#include <cstring>
+
+PutDataDevice::PutDataDevice(KIO::WorkerBase *worker, qint64 expectedSize)
+    : m_worker(worker)
+    , m_expectedSize(expectedSize)
+{
+}
+
+bool PutDataDevice::isSequential() const
+{
+    return true;
+}
+
+qint64 PutDataDevice::size() const
+{
+    return m_expectedSize;
+}
+
+qint64 PutDataDevice::bytesAvailable() const
+{
+    return (m_block.size() - m_blockOffset) + QIODevice::bytesAvailable();
+}
+
+bool PutDataDevice::atEnd() const
+{
+    return m_finished && m_blockOffset >= m_block.size();
+}
+
+QByteArray PutDataDevice::firstBlock()
+{
+    Q_ASSERT(m_blockOffset == 0);
+    if (m_block.isEmpty()) {
+        fetchBlock();
+    }
+    return m_block;
+}
+
+bool PutDataDevice::failed() const
+{
+    return m_failed;
+}
+
+const OneDrive::QuickXorHash &PutDataDevice::quickXorHash() const
+{
+    return m_hash;
+}
+
+bool PutDataDevice::fetchBlock()
+{
+    if (m_finished) {
+        return false;
+    }
+
+    m_block.clear();
+    m_blockOffset = 0;
+
+    m_worker->dataReq();
+    const int result = m_worker->readData(m_block);
+    if (result <= 0) {
+        m_finished = true;
+        if (result < 0) {
+            qCWarning(ONEDRIVE) << "Could not read put() data from the application";
+            m_failed = true;
+        }
+        return false;
+    }
+
+    m_hash.addData(m_block);
+    return true;
+}
+
+qint64 PutDataDevice::readData(char *data, qint64 maxSize)
+{
+    qint64 copied = 0;
+    while (copied < maxSize) {
+        if (m_blockOffset >= m_block.size() && !fetchBlock()) {
+            break;
+        }
+
+        const qint64 chunk = qMin<qint64>(maxSize - copied, m_block.size() - m_blockOffset);
+        std::memcpy(data + copied, m_block.constData() + m_blockOffset, chunk);
+        copied += chunk;
+        m_blockOffset += chunk;
+    }
+
+    if (copied == 0 && m_finished) {
+        return -1;
+    }
+    return copied;
+}
+
+qint64 PutDataDevice::writeData(const char *data, qint64 maxSize)
+{
+    Q_UNUSED(data)
+    Q_UNUSED(maxSize)
+    return -1;
+}
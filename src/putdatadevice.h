@@ -0,0 +1,65 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include "quickxorhash.h"
+
+#include <QByteArray>
+#include <QIODevice>
+
+namespace KIO
+{
+class WorkerBase;
+}
+
+/**
+ * Sequential device that pulls put() data from the KIO application on demand.
+ *
+ * Only the current data block is held in memory, so an upload can start sending
+ * as soon as the first block arrives instead of spilling the whole file to disk.
+ */
+class PutDataDevice : public QIODevice
+{
+public:
+    PutDataDevice(KIO::WorkerBase *worker, qint64 expectedSize);
+
+    bool isSequential() const override;
+    qint64 size() const override;
+    qint64 bytesAvailable() const override;
+    bool atEnd() const override;
+
+    /**
+     * @return The first data block without consuming it, e.g. for MIME sniffing.
+     * Must be called before anything has been read from the device.
+     */
+    QByteArray firstBlock();
+
+    /**
+     * @return Whether reading from the application failed.
+     */
+    bool failed() const;
+
+    /**
+     * @return The hash of all data fetched from the application so far.
+     */
+    const OneDrive::QuickXorHash &quickXorHash() const;
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    bool fetchBlock();
+
+    KIO::WorkerBase *m_worker;
+    qint64 m_expectedSize;
+    QByteArray m_block;
+    OneDrive::QuickXorHash m_hash;
+    qsizetype m_blockOffset = 0;
+    bool m_finished = false;
+    bool m_failed = false;
+};
@@ -0,0 +1,164 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "quickxorhash.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define QUICKXORHASH_SSE2
+#include <immintrin.h>
+#endif
+
+// AVX2 is picked at runtime, distributions build for a baseline without it.
+#if defined(QUICKXORHASH_SSE2) && (defined(__GNUC__) || defined(__clang__))
+#define QUICKXORHASH_AVX2
+#endif
+
+using namespace OneDrive;
+
+namespace
+{
+constexpr int Shift = 11;
+constexpr qsizetype WidthInBytes = 20;
+constexpr qsizetype WidthInBits = WidthInBytes * 8;
+// A byte lands at the same bit offset as the one 160 bytes before it.
+constexpr qsizetype BlockSize = 160;
+
+using FoldFunc = void (*)(quint8 *fold, const quint8 *data, qsizetype blocks);
+
+[[maybe_unused]] void foldBlocksScalar(quint8 *fold, const quint8 *data, qsizetype blocks)
+{
+    constexpr qsizetype Words = BlockSize / sizeof(quint64);
+    quint64 acc[Words];
+    std::memcpy(acc, fold, BlockSize);
+    for (; blocks > 0; --blocks, data += BlockSize) {
+        for (qsizetype i = 0; i < Words; ++i) {
+            quint64 word;
+            std::memcpy(&word, data + i * sizeof(quint64), sizeof(quint64));
+            acc[i] ^= word;
+        }
+    }
+    std::memcpy(fold, acc, BlockSize);
+}
+
+#ifdef QUICKXORHASH_SSE2
+void foldBlocksSse2(quint8 *fold, const quint8 *data, qsizetype blocks)
+{
+    constexpr qsizetype Lanes = BlockSize / sizeof(__m128i);
+    __m128i acc[Lanes];
+    for (qsizetype i = 0; i < Lanes; ++i) {
+        acc[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fold) + i);
+    }
+    for (; blocks > 0; --blocks, data += BlockSize) {
+        for (qsizetype i = 0; i < Lanes; ++i) {
+            acc[i] = _mm_xor_si128(acc[i], _mm_loadu_si128(reinterpret_cast<const __m128i *>(data) + i));
+        }
+    }
+    for (qsizetype i = 0; i < Lanes; ++i) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(fold) + i, acc[i]);
+    }
+}
+#endif
+
+#ifdef QUICKXORHASH_AVX2
+__attribute__((target("avx2"))) void foldBlocksAvx2(quint8 *fold, const quint8 *data, qsizetype blocks)
+{
+    constexpr qsizetype Lanes = BlockSize / sizeof(__m256i);
+    __m256i acc[Lanes];
+    for (qsizetype i = 0; i < Lanes; ++i) {
+        acc[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(fold) + i);
+    }
+    for (; blocks > 0; --blocks, data += BlockSize) {
+        for (qsizetype i = 0; i < Lanes; ++i) {
+            acc[i] = _mm256_xor_si256(acc[i], _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data) + i));
+        }
+    }
+    for (qsizetype i = 0; i < Lanes; ++i) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(fold) + i, acc[i]);
+    }
+}
+#endif
+
+FoldFunc selectFoldBlocks()
+{
+#ifdef QUICKXORHASH_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return foldBlocksAvx2;
+    }
+#endif
+#ifdef QUICKXORHASH_SSE2
+    return foldBlocksSse2;
+#else
+    return foldBlocksScalar;
+#endif
+}
+
+const FoldFunc foldBlocks = selectFoldBlocks();
+} // namespace
+
+void QuickXorHash::addData(QByteArrayView data)
+{
+    auto bytes = reinterpret_cast<const quint8 *>(data.data());
+    qsizetype remaining = data.size();
+    qsizetype position = m_length % BlockSize;
+    m_length += remaining;
+
+    // Bring the stream to a block boundary, fold whole blocks, keep the rest for the next call.
+    while (position != 0 && remaining > 0) {
+        m_fold[position] ^= *bytes++;
+        position = (position + 1) % BlockSize;
+        --remaining;
+    }
+    if (const qsizetype blocks = remaining / BlockSize; blocks > 0) {
+        foldBlocks(m_fold.data(), bytes, blocks);
+        bytes += blocks * BlockSize;
+        remaining -= blocks * BlockSize;
+    }
+    for (qsizetype i = 0; i < remaining; ++i) {
+        m_fold[i] ^= bytes[i];
+    }
+}
+
+void QuickXorHash::reset()
+{
+    m_fold.fill(0);
+    m_length = 0;
+}
+
+QByteArray QuickXorHash::result() const
+{
+    std::array<quint8, WidthInBytes> digest{};
+    for (qsizetype i = 0; i < BlockSize; ++i) {
+        const qsizetype bit = (i * Shift) % WidthInBits;
+        const qsizetype byte = bit / 8;
+        const int offset = bit % 8;
+        digest[byte] ^= quint8(m_fold[i] << offset);
+        if (offset != 0) {
+            digest[(byte + 1) % WidthInBytes] ^= quint8(m_fold[i] >> (8 - offset));
+        }
+    }
+
+    // The length goes into the last 8 bytes, little endian.
+    const auto length = static_cast<quint64>(m_length);
+    for (qsizetype i = 0; i < 8; ++i) {
+        digest[WidthInBytes - 8 + i] ^= quint8(length >> (8 * i));
+    }
+    return QByteArray(reinterpret_cast<const char *>(digest.data()), digest.size());
+}
+
+bool QuickXorHash::matches(const QString &base64Hash) const
+{
+    return QByteArray::fromBase64(base64Hash.toLatin1()) == result();
+}
+
+QByteArray QuickXorHash::hash(QByteArrayView data)
+{
+    QuickXorHash hasher;
+    hasher.addData(data);
+    return hasher.result();
+}
@@ -0,0 +1,46 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+
+#include <array>
+
+namespace OneDrive
+{
+/**
+ * OneDrive's QuickXorHash, the checksum Graph publishes as file.hashes.quickXorHash for every file.
+ *
+ * Each input byte is XORed into a 160 bit ring, 11 bits further along than the byte before it.
+ * As that offset repeats every 160 bytes, data is first folded into a 160 byte block, which is
+ * vectorized, and only spread over the ring when the result is asked for.
+ */
+class QuickXorHash
+{
+public:
+    void addData(QByteArrayView data);
+    void reset();
+
+    /**
+     * @return The 20 byte digest of the data added so far.
+     */
+    [[nodiscard]] QByteArray result() const;
+
+    /**
+     * @return Whether the data added so far has the digest @p base64Hash, as published by Graph.
+     */
+    [[nodiscard]] bool matches(const QString &base64Hash) const;
+
+    [[nodiscard]] static QByteArray hash(QByteArrayView data);
+
+private:
+    alignas(32) std::array<quint8, 160> m_fold{};
+    qint64 m_length = 0;
+};
+}
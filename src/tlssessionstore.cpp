@@ -0,0 +1,89 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "tlssessionstore.h"
+#include "onedrivedebug.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTimeZone>
+
+namespace
+{
+// Servers that don't send a lifetime hint still expire tickets, typically within hours.
+constexpr int DefaultTicketLifetimeSecs = 2 * 60 * 60;
+} // namespace
+
+TlsSessionStore::TlsSessionStore(const QString &filePath)
+    : m_filePath(filePath)
+{
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return;
+    }
+
+    // One "host expiry ticket" line per host, with the expiry in seconds since the epoch and the ticket in base64.
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    while (!file.atEnd()) {
+        const QList<QByteArray> fields = file.readLine().trimmed().split(' ');
+        if (fields.size() != 3) {
+            continue;
+        }
+        const QDateTime expiresAt = QDateTime::fromSecsSinceEpoch(fields.at(1).toLongLong(), QTimeZone::UTC);
+        const QByteArray ticket = QByteArray::fromBase64(fields.at(2));
+        if (expiresAt > now && !ticket.isEmpty()) {
+            m_sessions.insert(QString::fromUtf8(fields.at(0)), Session{ticket, expiresAt});
+        }
+    }
+}
+
+QByteArray TlsSessionStore::ticket(const QString &host) const
+{
+    const auto it = m_sessions.constFind(host);
+    if (it == m_sessions.constEnd() || it->expiresAt <= QDateTime::currentDateTimeUtc()) {
+        return {};
+    }
+    return it->ticket;
+}
+
+void TlsSessionStore::insert(const QString &host, const QByteArray &ticket, int lifetimeHintSecs)
+{
+    if (host.isEmpty() || ticket.isEmpty() || m_sessions.value(host).ticket == ticket) {
+        return;
+    }
+
+    const int lifetimeSecs = lifetimeHintSecs > 0 ? lifetimeHintSecs : DefaultTicketLifetimeSecs;
+    m_sessions.insert(host, Session{ticket, QDateTime::currentDateTimeUtc().addSecs(lifetimeSecs)});
+    save();
+}
+
+void TlsSessionStore::save() const
+{
+    if (m_filePath.isEmpty() || !QDir().mkpath(QFileInfo(m_filePath).path())) {
+        return;
+    }
+
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qCWarning(ONEDRIVE) << "Cannot write" << m_filePath << file.errorString();
+        return;
+    }
+    // Restrict the temporary file before any secret goes into it.
+    file.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    for (auto it = m_sessions.constBegin(); it != m_sessions.constEnd(); ++it) {
+        if (it->expiresAt <= now) {
+            continue;
+        }
+        file.write(it.key().toUtf8() + ' ' + QByteArray::number(it->expiresAt.toSecsSinceEpoch()) + ' ' + it->ticket.toBase64() + '\n');
+    }
+    if (!file.commit()) {
+        qCWarning(ONEDRIVE) << "Cannot write" << m_filePath << file.errorString();
+    }
+}
@@ -0,0 +1,45 @@
+/*
+ * SPDX-FileCopyrightText: 2026 KDE Contributors
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+
+/**
+ * TLS session tickets by host, kept in a file readable only by the user so that new worker
+ * processes can resume sessions instead of doing full handshakes.
+ *
+ * A ticket holds the session's secrets, which is why the file must not be world-readable.
+ */
+class TlsSessionStore
+{
+public:
+    explicit TlsSessionStore(const QString &filePath);
+
+    /**
+     * @return The ticket last seen for @p host, or an empty one if there is none or it expired.
+     */
+    [[nodiscard]] QByteArray ticket(const QString &host) const;
+
+    /**
+     * Remembers @p ticket for @p host for @p lifetimeHintSecs, writing the file if it is new.
+     */
+    void insert(const QString &host, const QByteArray &ticket, int lifetimeHintSecs);
+
+private:
+    struct Session {
+        QByteArray ticket;
+        QDateTime expiresAt;
+    };
+
+    void save() const;
+
+    QString m_filePath;
+    QHash<QString /* host */, Session> m_sessions;
+};